@@ -0,0 +1,115 @@
+#include "harness.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <iomanip>
+#include <numeric>
+
+using namespace bench;
+
+void suite::add(const std::string& name, setupFn setup, long long param) {
+    entries.push_back({ name, param, std::move(setup) });
+}
+
+static double secondsFor(const timedLoop& loop, long long n) {
+    auto start = std::chrono::steady_clock::now();
+    loop(n);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+std::vector<result> suite::run(const options& opts, std::ostream& progress) const {
+    std::vector<result> results;
+    for (const entry& e : entries) {
+        std::string fullName = e.param ? e.name + "/" + std::to_string(e.param) : e.name;
+        if (!opts.filter.empty() && fullName.find(opts.filter) == std::string::npos) {
+            continue;
+        }
+
+        result r = { fullName, e.param, 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0, false, "" };
+        try {
+            timedLoop loop = e.setup();
+
+            // Warm up and calibrate
+            long long n = 1;
+            while (secondsFor(loop, n) < opts.minSeconds && n < (1ll << 40)) {
+                n *= 2;
+            }
+
+            std::vector<double> samples;
+            for (int rep = 0; rep < opts.repetitions; ++rep) {
+                samples.push_back(secondsFor(loop, n) * 1e9 / static_cast<double>(n));
+            }
+            std::sort(samples.begin(), samples.end());
+            double mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+            double variance = 0.0;
+            for (double s : samples) {
+                variance += (s - mean) * (s - mean);
+            }
+            r.iterations = n;
+            r.repetitions = opts.repetitions;
+            r.medianNs = samples[samples.size() / 2];
+            r.meanNs = mean;
+            r.minNs = samples.front();
+            r.maxNs = samples.back();
+            r.stddevNs = std::sqrt(variance / samples.size());
+        } catch (const std::exception& ex) {
+            r.skipped = true;
+            r.note = ex.what();
+        }
+
+        progress << std::left << std::setw(48) << fullName;
+        if (r.skipped) {
+            progress << "skipped: " << r.note << "\n";
+        } else {
+            progress << std::right << std::setw(14) << std::fixed << std::setprecision(1) << r.medianNs << " ns"
+                     << "  (min " << r.minNs << ", stddev " << r.stddevNs << ")\n";
+        }
+        progress.flush();
+        results.push_back(r);
+    }
+    return results;
+}
+
+static std::string escape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += (c == '\n') ? ' ' : c;
+    }
+    return out;
+}
+
+void bench::writeJson(std::ostream& out, const std::vector<result>& results, const std::string& label) {
+    out << "{\n  \"context\": {\n";
+    out << "    \"label\": \"" << escape(label) << "\",\n";
+#if defined(__VERSION__)
+    out << "    \"compiler\": \"" << escape(__VERSION__) << "\",\n";
+#elif defined(_MSC_VER)
+    out << "    \"compiler\": \"msvc " << _MSC_VER << "\",\n";
+#endif
+#ifdef NDEBUG
+    out << "    \"build\": \"release\"\n";
+#else
+    out << "    \"build\": \"debug\"\n";
+#endif
+    out << "  },\n  \"benchmarks\": [\n";
+    out << std::setprecision(6) << std::defaultfloat;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const result& r = results[i];
+        out << "    {\"name\": \"" << escape(r.name) << "\", \"param\": " << r.param;
+        if (r.skipped) {
+            out << ", \"skipped\": true, \"note\": \"" << escape(r.note) << "\"}";
+        } else {
+            out << ", \"iterations\": " << r.iterations << ", \"repetitions\": " << r.repetitions
+                << ", \"median_ns\": " << r.medianNs << ", \"mean_ns\": " << r.meanNs
+                << ", \"min_ns\": " << r.minNs << ", \"max_ns\": " << r.maxNs
+                << ", \"stddev_ns\": " << r.stddevNs << "}";
+        }
+        out << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
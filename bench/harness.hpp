@@ -0,0 +1,62 @@
+#pragma once
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+struct result {
+    std::string name;
+    long long param;       // problem size, 0 if not a scaling case
+    long long iterations;  // per repetition
+    int repetitions;
+    double medianNs;       // per iteration
+    double meanNs;
+    double minNs;
+    double maxNs;
+    double stddevNs;
+    bool skipped;
+    std::string note;
+};
+
+// A case is a setup function that builds whatever state it needs (outside the
+// timed region) and returns the loop to time; the loop runs its body n times
+using timedLoop = std::function<void(long long n)>;
+using setupFn = std::function<timedLoop()>;
+
+struct options {
+    std::string filter;
+    int repetitions = 10;
+    double minSeconds = 0.05; // iterations are doubled until one repetition takes this long
+};
+
+class suite {
+private:
+    struct entry {
+        std::string name;
+        long long param;
+        setupFn setup;
+    };
+    std::vector<entry> entries;
+public:
+    void add(const std::string& name, setupFn setup, long long param = 0);
+    std::vector<result> run(const options& opts, std::ostream& progress) const;
+};
+
+// One JSON document per run so results can be diffed across commits
+void writeJson(std::ostream& out, const std::vector<result>& results, const std::string& label);
+
+// Keeps the compiler from discarding a computed value
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+}
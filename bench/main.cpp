@@ -0,0 +1,656 @@
+#include <box2d/box2d.h>
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "harness.hpp"
+#include "body.hpp"
+#include "drone.hpp"
+#include "draw.hpp"
+#include "entity_registry.hpp"
+#include "force_arrows.hpp"
+#include "sprite_atlas.hpp"
+#include "simulation.hpp"
+#include "snapshot.hpp"
+#include "swarm.hpp"
+#include "wind_field.hpp"
+#include "drone_dynamics.hpp"
+#include "thread_pool.hpp"
+#include "telemetry.hpp"
+#include "controller/pid.hpp"
+#include "controller/pipeline.hpp"
+#include "controller/mppi.hpp"
+#include "controller/mixer.hpp"
+#include "estimation/sensors.hpp"
+#include "estimation/estimator.hpp"
+
+// C++ heap allocations made by the calling thread, so the churn cases can check
+// that a warmed-up registry spawns and destroys without allocating
+static thread_local size_t heapAllocations = 0;
+
+void* operator new(std::size_t size) {
+    ++heapAllocations;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// A world with `count` hovering drones laid out on a grid far enough apart
+// that they never touch, built the same way as the --swarm mode. With threads
+// > 0 the world steps on a private pool of that size.
+struct droneScene {
+    simulationConfig config;
+    std::unique_ptr<threadPool> pool;
+    b2WorldId worldId;
+    std::unique_ptr<entityRegistry> entities;
+    std::vector<entityHandle> airframes;
+    swarm fleet;
+
+    explicit droneScene(int count, unsigned int threads = 0) {
+        b2WorldDef worldDef = b2DefaultWorldDef();
+        worldDef.gravity = {0.0f, -9.81f};
+        if (threads > 0) {
+            threadPoolConfig poolConfig;
+            poolConfig.threads = threads;
+            pool = std::make_unique<threadPool>(poolConfig);
+            pool->attach(worldDef);
+        }
+        worldId = b2CreateWorld(&worldDef);
+
+        float density = (50.0f * 50.0f) / (config.droneWidth * config.droneHeight);
+        float motorOffsetX = config.droneWidth * 0.45f;
+        float motorOffsetY = config.droneHeight * 0.3f;
+        std::vector<b2Vec2> motorLocal = { { -motorOffsetX, motorOffsetY }, { motorOffsetX, motorOffsetY } };
+        std::vector<b2Vec2> motorDirections = { { 0.0f, 1.0f }, { 0.0f, 1.0f } };
+
+        const int columns = 100;
+        entities = std::make_unique<entityRegistry>(worldId, count);
+        airframes.reserve(count);
+        fleet.reserve(count, motorLocal.size());
+        for (int i = 0; i < count; ++i) {
+            b2Vec2 position = { (i % columns) * config.droneWidth * 1.5f, 100.0f + (i / columns) * config.droneHeight * 3.0f };
+            airframes.push_back(entities->spawnDrone(position, config.droneHeight, config.droneWidth, density, motorLocal, motorDirections, config.maxThrustPerMotor));
+            fleet.addDrone(getDrone(i));
+        }
+    }
+    ~droneScene() {
+        b2DestroyWorld(worldId);
+    }
+    droneScene(const droneScene&) = delete;
+    droneScene& operator=(const droneScene&) = delete;
+
+    body& getBody(size_t i) { return *entities->getBody(airframes[i]); }
+    drone& getDrone(size_t i) { return *entities->getDrone(airframes[i]); }
+
+    void hover() {
+        fleet.syncState();
+        for (size_t i = 0; i < fleet.size(); ++i) {
+            float thrust = fleet.gravitationalForce(i) - config.kd * fleet.getLinearVelocity(i).y;
+            fleet.setThrustEvenly(i, thrust);
+        }
+        fleet.applyCommands();
+    }
+};
+
+static control::measurement syntheticMeasurement(long long i) {
+    float phase = static_cast<float>(i % 1000) * 0.001f;
+    return control::measurement{ 400.0f + phase, 100.0f + phase, 0.01f * phase, 0.0f, 0.0f, 0.0f, 24525.0f };
+}
+
+static void registerPhysics(bench::suite& suite) {
+    suite.add("drone/applyThrust", []() -> bench::timedLoop {
+        auto scene = std::make_shared<droneScene>(1);
+        return [scene](long long n) {
+            drone& d = scene->getDrone(0);
+            for (long long i = 0; i < n; ++i) {
+                d.applyThrust(0, 10000.0f);
+                d.applyThrust(1, 10000.0f);
+            }
+        };
+    });
+
+    suite.add("drone/applyThrustEvenly", []() -> bench::timedLoop {
+        auto scene = std::make_shared<droneScene>(1);
+        return [scene](long long n) {
+            drone& d = scene->getDrone(0);
+            for (long long i = 0; i < n; ++i) {
+                d.applyThrustEvenly(20000.0f);
+            }
+        };
+    });
+
+    suite.add("body/getTransformedVertices/vector", []() -> bench::timedLoop {
+        auto scene = std::make_shared<droneScene>(1);
+        return [scene](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                std::vector<b2Vec2> vertices = scene->getBody(0).getTransformedVertices();
+                bench::doNotOptimize(vertices.data());
+            }
+        };
+    });
+
+    suite.add("body/getTransformedVertices/into", []() -> bench::timedLoop {
+        auto scene = std::make_shared<droneScene>(1);
+        return [scene](long long n) {
+            b2Vec2 vertices[maxShapeVertices];
+            for (long long i = 0; i < n; ++i) {
+                int count = scene->getBody(0).getTransformedVertices(0, vertices);
+                bench::doNotOptimize(vertices[count - 1]);
+            }
+        };
+    });
+
+    for (int drones : { 1, 10, 100, 1000, 10000 }) {
+        suite.add("world/step", [drones]() -> bench::timedLoop {
+            auto scene = std::make_shared<droneScene>(drones);
+            return [scene](long long n) {
+                for (long long i = 0; i < n; ++i) {
+                    scene->hover();
+                    b2World_Step(scene->worldId, scene->config.timeStep, scene->config.subStepCount);
+                }
+            };
+        }, drones);
+
+        suite.add("dynamics/step", [drones]() -> bench::timedLoop {
+            auto scene = std::make_shared<droneScene>(1);
+            auto fleet = std::make_shared<droneDynamics>(makeDroneModel(scene->getDrone(0)), scene->config.subStepCount);
+            fleet->reserve(drones);
+            for (int i = 0; i < drones; ++i) {
+                fleet->addDrone({ { i * 10.0f, 100.0f }, b2MakeRot(0.0f), { 0.0f, 0.0f }, 0.0f });
+                fleet->setThrustEvenly(i, fleet->weight());
+            }
+            float timeStep = scene->config.timeStep;
+            return [fleet, timeStep](long long n) {
+                for (long long i = 0; i < n; ++i) {
+                    fleet->step(timeStep);
+                }
+            };
+        }, drones);
+
+        suite.add("swarm/applyCommands", [drones]() -> bench::timedLoop {
+            auto scene = std::make_shared<droneScene>(drones);
+            return [scene](long long n) {
+                for (long long i = 0; i < n; ++i) {
+                    scene->hover();
+                }
+            };
+        }, drones);
+
+        // Turbulent field with gusts over a 1 km square; one advance plus a sample at both span ends per drone
+        suite.add("wind/computeWindLoads", [drones]() -> bench::timedLoop {
+            struct state {
+                windField field;
+                std::vector<float> posX, posY, rotC, rotS, velX, velY, thrust;
+                std::vector<float> forceX, forceY, torque;
+            };
+            windConfig settings;
+            settings.mean = { 10.0f, 0.0f };
+            settings.turbulence = 3.0f;
+            settings.gustSpeed = 8.0f;
+            auto s = std::make_shared<state>(state{ windField(windConfigOver(settings, { 0.0f, 0.0f }, { 1000.0f, 1000.0f }, 50.0f)) });
+            for (int i = 0; i < drones; ++i) {
+                s->posX.push_back(static_cast<float>((i * 37) % 1000));
+                s->posY.push_back(static_cast<float>((i * 91) % 1000));
+                s->rotC.push_back(1.0f);
+                s->rotS.push_back(0.0f);
+                s->velX.push_back(0.0f);
+                s->velY.push_back(0.0f);
+                s->thrust.push_back(20000.0f);
+            }
+            s->forceX.resize(drones);
+            s->forceY.resize(drones);
+            s->torque.resize(drones);
+            simulationConfig config;
+            airframeDrag airframe = airframeDragFor(config);
+            return [s, airframe, drones](long long n) {
+                windBodies bodies;
+                bodies.count = drones;
+                bodies.posX = s->posX.data();
+                bodies.posY = s->posY.data();
+                bodies.rotC = s->rotC.data();
+                bodies.rotS = s->rotS.data();
+                bodies.velX = s->velX.data();
+                bodies.velY = s->velY.data();
+                bodies.thrust = s->thrust.data();
+                for (long long i = 0; i < n; ++i) {
+                    s->field.advance(i * (1.0f / 60.0f));
+                    computeWindLoads(s->field, airframe, bodies, { s->forceX.data(), s->forceY.data(), s->torque.data() });
+                    bench::doNotOptimize(s->torque.data());
+                }
+            };
+        }, drones);
+    }
+}
+
+// Steady churn at a population of 5000, a quarter of them drones: each iteration
+// destroys the oldest `batch` entities and spawns replacements, which reuse the
+// freed slots. The case is reported skipped if the warmed-up registry allocates
+// or a handle to a destroyed entity still resolves.
+static void registerRegistry(bench::suite& suite) {
+    for (int batch : { 10, 100, 1000 }) {
+        suite.add("registry/spawnDespawn", [batch]() -> bench::timedLoop {
+            struct state {
+                b2WorldId worldId;
+                std::unique_ptr<entityRegistry> entities;
+                std::vector<entityHandle> live;
+                std::vector<b2Vec2> motorPositions = control::evenMotorPositions(4, 40.0f, 8.0f);
+                std::vector<b2Vec2> motorDirections = control::verticalMotorDirections(4);
+                size_t oldest = 0;
+                state() {
+                    b2WorldDef worldDef = b2DefaultWorldDef();
+                    worldId = b2CreateWorld(&worldDef);
+                    entities = std::make_unique<entityRegistry>(worldId, 5000);
+                }
+                ~state() {
+                    entities.reset();
+                    b2DestroyWorld(worldId);
+                }
+                entityHandle spawn(size_t at) {
+                    b2Vec2 position = { (at % 100) * 100.0f, (at / 100) * 40.0f };
+                    if (at % 4 == 0) {
+                        return entities->spawnDrone(position, 10.0f, 90.0f, 1.0f, motorPositions, motorDirections, 20000.0f);
+                    }
+                    return entities->spawnBox(position, 10.0f, 10.0f, b2_dynamicBody);
+                }
+            };
+            auto s = std::make_shared<state>();
+            for (size_t i = 0; i < 5000; ++i) {
+                s->live.push_back(s->spawn(i));
+            }
+            return [s, batch](long long n) {
+                size_t allocations = heapAllocations;
+                for (long long i = 0; i < n; ++i) {
+                    for (int k = 0; k < batch; ++k) {
+                        size_t at = s->oldest++ % s->live.size();
+                        entityHandle stale = s->live[at];
+                        s->entities->destroy(stale);
+                        s->live[at] = s->spawn(at);
+                        if (s->entities->isAlive(stale) || s->entities->getBody(stale) || s->entities->getDrone(stale)) {
+                            throw std::runtime_error("a destroyed entity's handle still resolves");
+                        }
+                    }
+                }
+                if (heapAllocations != allocations) {
+                    throw std::runtime_error("the registry allocated while spawning and destroying");
+                }
+            };
+        }, batch);
+    }
+}
+
+// Thread scaling of one large world; the parameter is the pool size
+static void registerThreading(bench::suite& suite) {
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int threads : { 1u, 2u, 4u, 8u, 16u }) {
+        if (threads > cores) {
+            break;
+        }
+        suite.add("world/step/threads", [threads]() -> bench::timedLoop {
+            auto scene = std::make_shared<droneScene>(10000, threads);
+            return [scene](long long n) {
+                for (long long i = 0; i < n; ++i) {
+                    scene->hover();
+                    b2World_Step(scene->worldId, scene->config.timeStep, scene->config.subStepCount);
+                }
+            };
+        }, threads);
+    }
+
+    suite.add("threadPool/parallelFor", []() -> bench::timedLoop {
+        auto values = std::make_shared<std::vector<float>>(1 << 16, 1.0f);
+        return [values](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                sharedThreadPool().parallelFor(values->size(), 1024, [&](size_t begin, size_t end) {
+                    for (size_t k = begin; k < end; ++k) {
+                        (*values)[k] = (*values)[k] * 0.999f + 0.001f;
+                    }
+                });
+            }
+            bench::doNotOptimize((*values)[0]);
+        };
+    });
+}
+
+// Per-step cost on the physics thread: command poll, record encoding and, every
+// `batch` steps, one non-blocking send to a loopback port nobody listens on
+static void registerTelemetry(bench::suite& suite) {
+    for (int batch : { 1, 4, 16 }) {
+        suite.add("telemetry/afterStep", [batch]() -> bench::timedLoop {
+            struct state {
+                simulation sim;
+                telemetryServer server;
+                uint64_t step = 0;
+            };
+            auto s = std::make_shared<state>();
+            telemetryConfig link;
+            link.port = sf::Socket::AnyPort;
+            link.peer = sf::IpAddress::LocalHost;
+            link.peerPort = telemetry::defaultPort;
+            link.batch = batch;
+            s->server.open(link);
+            s->sim.step();
+            return [s](long long n) {
+                for (long long i = 0; i < n; ++i) {
+                    s->server.afterStep(++s->step, s->sim);
+                }
+            };
+        }, batch);
+    }
+}
+
+static void registerControl(bench::suite& suite) {
+    suite.add("hoverController/update", []() -> bench::timedLoop {
+        auto sim = std::make_shared<simulation>();
+        return [sim](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                sim->getController().update(sim->getTargetAltitude(), sim->getConfig().timeStep);
+            }
+        };
+    });
+
+    suite.add("control/pidTerm", []() -> bench::timedLoop {
+        auto term = std::make_shared<control::filteredPid>();
+        term->kp = 1.0f;
+        term->ki = 0.0005f;
+        term->kd = 200.0f;
+        return [term](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                float out = term->update(120.0f - syntheticMeasurement(i).y, 0.001f);
+                bench::doNotOptimize(out);
+            }
+        };
+    });
+
+    suite.add("control/altitudeAttitudeController", []() -> bench::timedLoop {
+        auto sim = std::make_shared<simulation>();
+        return [sim](long long n) {
+            control::setpoint sp = { 400.0f, 120.0f };
+            for (long long i = 0; i < n; ++i) {
+                control::command c = sim->getCascade().update(syntheticMeasurement(i), sp, 0.001f);
+                bench::doNotOptimize(c);
+            }
+        };
+    });
+
+    // Full per-step estimate path: sample both sensors, predict, correct
+    suite.add("estimation/sensorsAndEstimator", []() -> bench::timedLoop {
+        auto scene = std::make_shared<droneScene>(1);
+        auto imuSensor = std::make_shared<estimation::imu>();
+        auto baro = std::make_shared<estimation::barometer>();
+        auto estimator = std::make_shared<estimation::stateEstimator>();
+        estimator->reset(scene->getBody(0).bodyId);
+        return [scene, imuSensor, baro, estimator](long long n) {
+            b2BodyId bodyId = scene->getBody(0).bodyId;
+            const float dt = 1.0f / 240.0f;
+            for (long long i = 0; i < n; ++i) {
+                estimator->predict(imuSensor->sample(bodyId, dt), dt);
+                estimator->correctAltitude(baro->sample(bodyId, dt));
+                control::measurement m = estimator->estimate(24525.0f);
+                bench::doNotOptimize(m);
+            }
+        };
+    });
+
+    suite.add("estimation/kalmanOnly", []() -> bench::timedLoop {
+        auto estimator = std::make_shared<estimation::stateEstimator>();
+        return [estimator](long long n) {
+            const float dt = 1.0f / 240.0f;
+            for (long long i = 0; i < n; ++i) {
+                float phase = static_cast<float>(i % 1000) * 0.001f;
+                estimator->predict({ 0.01f * phase, 9.81f + phase, 0.001f }, dt);
+                estimator->correctAltitude(100.0f + phase);
+                bench::doNotOptimize(estimator);
+            }
+        };
+    });
+
+    // One full plan per iteration: noise, rollouts across all cores, weighted update
+    for (int samples : { 256, 1024, 4096 }) {
+        suite.add("control/mppi", [samples]() -> bench::timedLoop {
+            auto scene = std::make_shared<droneScene>(1);
+            control::mppiConfig config;
+            config.samples = samples;
+            auto planner = std::make_shared<control::mppiController>(&scene->getDrone(0), config);
+            return [scene, planner](long long n) {
+                control::setpoint sp = { 400.0f, 120.0f };
+                for (long long i = 0; i < n; ++i) {
+                    planner->update(syntheticMeasurement(i), sp, 1.0f / 240.0f);
+                }
+            };
+        }, samples);
+    }
+
+    suite.add("control/positionController", []() -> bench::timedLoop {
+        auto controller = std::make_shared<control::positionController>();
+        return [controller](long long n) {
+            control::setpoint sp = { 400.0f, 120.0f };
+            for (long long i = 0; i < n; ++i) {
+                control::command c = controller->update(syntheticMeasurement(i), sp, 0.001f);
+                bench::doNotOptimize(c);
+            }
+        };
+    });
+
+    // Batched allocation for 1000 drones per iteration; a third of them saturate
+    for (int motors : { 2, 4, 6, 8 }) {
+        suite.add("control/mixer/batch1000", [motors]() -> bench::timedLoop {
+            struct state {
+                control::motorMixer mixer;
+                std::vector<float> collective, torque, thrust;
+            };
+            auto s = std::make_shared<state>();
+            s->mixer = control::motorMixer(control::evenMotorPositions(motors, 40.0f, 8.0f), control::verticalMotorDirections(motors), 20000.0f);
+            for (int i = 0; i < 1000; ++i) {
+                s->collective.push_back(20000.0f * motors * (0.2f + 0.001f * i));
+                s->torque.push_back(2.0e5f * ((i % 7) - 3));
+            }
+            s->thrust.resize(1000 * motors);
+            return [s](long long n) {
+                for (long long i = 0; i < n; ++i) {
+                    s->mixer.mix(s->collective.data(), s->torque.data(), s->collective.size(), s->thrust.data());
+                    bench::doNotOptimize(s->thrust[0]);
+                }
+            };
+        }, motors);
+    }
+
+    suite.add("control/altitudeAttitudeController+box2d", []() -> bench::timedLoop {
+        auto sim = std::make_shared<simulation>();
+        return [sim](long long n) {
+            control::setpoint sp = { 400.0f, sim->getTargetAltitude() };
+            for (long long i = 0; i < n; ++i) {
+                control::command c = sim->getCascade().update(control::measure(sim->getDrone()), sp, sim->getConfig().timeStep);
+                control::applyCommand(sim->getDrone(), c);
+            }
+        };
+    });
+}
+
+static void registerRendering(bench::suite& suite) {
+    for (int shapes : { 10, 100, 1000 }) {
+        suite.add("draw/drawShapes/offscreen", [shapes]() -> bench::timedLoop {
+            struct state {
+                droneScene scene;
+                draw drawer;
+                state(int shapes) : scene(shapes), drawer(800, 600, true) {}
+            };
+            auto s = std::make_shared<state>(shapes);
+            for (entityHandle airframe : s->scene.airframes) {
+                s->drawer.addShape(*s->scene.entities, airframe);
+            }
+            return [s](long long n) {
+                for (long long i = 0; i < n; ++i) {
+                    s->drawer.clear();
+                    s->drawer.drawShapes();
+                    s->drawer.display();
+                }
+            };
+        }, shapes);
+    }
+
+    // A 10000-body world seen through an 800x600 view: at 100% only a corner
+    // is queried and drawn, at 5% the whole world is in view
+    for (int zoomPercent : { 100, 5 }) {
+        suite.add("draw/drawShapes/camera", [zoomPercent]() -> bench::timedLoop {
+            struct state {
+                droneScene scene;
+                draw drawer;
+                state() : scene(10000), drawer(800, 600, true) {}
+            };
+            auto s = std::make_shared<state>();
+            for (entityHandle airframe : s->scene.airframes) {
+                s->drawer.addShape(*s->scene.entities, airframe);
+            }
+            s->drawer.getCamera().setZoom(zoomPercent / 100.0f);
+            return [s](long long n) {
+                for (long long i = 0; i < n; ++i) {
+                    s->drawer.clear();
+                    s->drawer.drawShapes();
+                    s->drawer.display();
+                }
+            };
+        }, zoomPercent);
+    }
+
+    // The same drones with mixed skins, one sf::Sprite draw each against one
+    // batched draw from the atlas
+    for (bool batched : { false, true }) {
+        for (int drones : { 100, 1000, 10000 }) {
+            suite.add(batched ? "draw/spriteBatch" : "draw/sprites", [batched, drones]() -> bench::timedLoop {
+                struct state {
+                    spriteAtlas atlas;
+                    sf::RenderTexture target;
+                    std::vector<sf::Texture> textures;
+                    state() : target(sf::Vector2u(800, 600)) {}
+                };
+                auto s = std::make_shared<state>();
+                if (addDroneSkins(s->atlas) == 0 || !s->atlas.build()) {
+                    throw std::runtime_error("drone atlas unavailable");
+                }
+                // One texture per skin, as the front ends had before the atlas
+                sf::Image sheet = s->atlas.getTexture().copyToImage();
+                for (size_t skin = 0; skin < s->atlas.size(); ++skin) {
+                    s->textures.emplace_back(sheet, false, s->atlas.getRegion(skin));
+                }
+                return [s, batched, drones](long long n) {
+                    spriteBatch batch(s->atlas);
+                    for (long long i = 0; i < n; ++i) {
+                        s->target.clear();
+                        for (int d = 0; d < drones; ++d) {
+                            size_t skin = d % s->atlas.size();
+                            sf::Vector2f position((d * 37) % 800, (d * 53) % 600);
+                            sf::Angle rotation = sf::degrees(static_cast<float>(d % 360));
+                            if (batched) {
+                                batch.add(skin, position, rotation, 0.15f);
+                            } else {
+                                sf::Sprite sprite(s->textures[skin]);
+                                sf::Vector2f size(s->textures[skin].getSize());
+                                sprite.setOrigin(size / 2.0f);
+                                sprite.setScale(sf::Vector2f(0.15f, 0.15f));
+                                sprite.setPosition(position);
+                                sprite.setRotation(rotation);
+                                s->target.draw(sprite);
+                            }
+                        }
+                        batch.flush(s->target);
+                        s->target.display();
+                    }
+                };
+            }, drones);
+        }
+    }
+
+    for (int drones : { 1, 100, 1000 }) {
+        suite.add("forceArrows/addNetForces", [drones]() -> bench::timedLoop {
+            struct state {
+                droneScene scene;
+                sf::RenderTexture target;
+                ForceArrowDrawer arrows;
+                std::vector<droneSnapshot> snapshots;
+                state(int drones) : scene(drones), target(sf::Vector2u(800, 600)), arrows(0.3f, 12.0f) {}
+            };
+            auto s = std::make_shared<state>(drones);
+            s->scene.hover();
+            s->snapshots.resize(s->scene.airframes.size());
+            for (size_t i = 0; i < s->scene.airframes.size(); ++i) {
+                captureDrone(s->scene.getDrone(i), s->snapshots[i]);
+            }
+            return [s](long long n) {
+                viewTransform view;
+                view.offsetY = 600.0f;
+                for (long long i = 0; i < n; ++i) {
+                    s->arrows.addNetForces(s->snapshots, view);
+                    s->arrows.flush(s->target);
+                }
+            };
+        }, drones);
+    }
+}
+
+int main(int argc, char** argv) {
+    bench::options opts;
+    std::string jsonPath;
+    std::string label;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            opts.filter = argv[++i];
+        } else if (arg == "--repetitions" && i + 1 < argc) {
+            opts.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            opts.minSeconds = std::atof(argv[++i]);
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (arg == "--label" && i + 1 < argc) {
+            label = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--filter TEXT] [--repetitions N] [--min-time SECONDS] [--json FILE] [--label TEXT]" << std::endl;
+            return 1;
+        }
+    }
+#ifdef DRONE_CONTROL_GIT_COMMIT
+    if (label.empty()) {
+        label = DRONE_CONTROL_GIT_COMMIT;
+    }
+#endif
+
+    bench::suite suite;
+    registerPhysics(suite);
+    registerRegistry(suite);
+    registerThreading(suite);
+    registerTelemetry(suite);
+    registerControl(suite);
+    registerRendering(suite);
+
+    // Human-readable progress on stderr, JSON on stdout or to --json
+    std::vector<bench::result> results = suite.run(opts, std::cerr);
+    if (jsonPath.empty()) {
+        bench::writeJson(std::cout, results, label);
+    } else {
+        std::ofstream out(jsonPath);
+        if (!out) {
+            std::cerr << "Failed to write " << jsonPath << std::endl;
+            return 1;
+        }
+        bench::writeJson(out, results, label);
+        std::cerr << "Wrote " << jsonPath << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,41 @@
+# Writes a C++ source holding every file under ASSET_DIR as a byte array, plus
+# the name table read by src/assets.cpp. Names are paths relative to ASSET_DIR.
+#   cmake -DASSET_DIR=<dir> -DOUTPUT=<file.cpp> -P embed_assets.cmake
+
+file(GLOB_RECURSE assets RELATIVE "${ASSET_DIR}" "${ASSET_DIR}/*")
+list(SORT assets)
+
+set(arrays "")
+set(table "")
+set(index 0)
+foreach(asset IN LISTS assets)
+    file(READ "${ASSET_DIR}/${asset}" hex HEX)
+    string(LENGTH "${hex}" digits)
+    math(EXPR size "${digits} / 2")
+    # 32 bytes per line keeps the generated file readable by editors and diff tools
+    string(REGEX REPLACE "(................................................................)" "\\1\n" hex "${hex}")
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+    # A trailing zero byte, not counted in the size, so empty files still compile
+    # and text assets are terminated
+    string(APPEND arrays "alignas(16) static const unsigned char asset${index}[] = {\n${bytes}0x00\n};\n\n")
+    string(APPEND table "    { \"${asset}\", asset${index}, ${size} },\n")
+    math(EXPR index "${index} + 1")
+endforeach()
+
+if(index EQUAL 0)
+    set(table "    { nullptr, nullptr, 0 },\n")
+endif()
+
+file(WRITE "${OUTPUT}.tmp"
+"// Generated by cmake/embed_assets.cmake from ${ASSET_DIR}; do not edit.
+#include \"assets.hpp\"
+
+${arrays}static const embeddedAsset table[] = {
+${table}};
+
+const embeddedAsset* embeddedAssetTable = table;
+const size_t embeddedAssetCount = ${index};
+")
+# Only touch the output when the contents change, so unchanged assets do not recompile
+file(COPY_FILE "${OUTPUT}.tmp" "${OUTPUT}" ONLY_IF_DIFFERENT)
+file(REMOVE "${OUTPUT}.tmp")
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+// A file from src/assets, compiled into the binary by cmake/embed_assets.cmake
+// so nothing is read from disk at run time
+struct embeddedAsset {
+    const char* name; // path relative to src/assets, e.g. "drone.png"
+    const unsigned char* data;
+    size_t size;
+};
+
+// Defined in the generated embedded_assets.cpp
+extern const embeddedAsset* embeddedAssetTable;
+extern const size_t embeddedAssetCount;
+
+// nullptr when there is no asset by that name
+const embeddedAsset* findAsset(std::string_view name);
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string_view>
+#include <SFML/Graphics.hpp>
+
+// Minimal built-in 5x7 pixel font so overlays can print text without a font file.
+// Covers digits, upper-case letters (lower case is drawn as upper case) and a
+// few punctuation marks; everything is appended to a triangle vertex array.
+void appendRect(sf::VertexArray& triangles, sf::Vector2f position, sf::Vector2f size, sf::Color color);
+void appendText(sf::VertexArray& triangles, sf::Vector2f position, std::string_view text, float pixelSize, sf::Color color);
+float textWidth(std::string_view text, float pixelSize);
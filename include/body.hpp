@@ -3,13 +3,43 @@
 #include <vector>
 #include <box2d/box2d.h>
 
+// Every shape outline fits in Box2D's polygon vertex limit; circles and capsules
+// are tessellated to the same bound so all shapes share one render path
+constexpr int maxShapeVertices = B2_MAX_POLYGON_VERTICES;
+
+struct shapeOutline {
+    b2Vec2 vertices[maxShapeVertices];
+    int count;
+};
+
+// Most shapes one body may carry; kept inline so bodies copy without allocating
+constexpr int maxBodyShapes = 8;
+
 class body {
 private:
-    b2ShapeId shapeId;
+    b2ShapeId shapeIds[maxBodyShapes] = {};
+    int shapeCount;
+    b2ShapeDef makeShapeDef(float density, bool collide) const;
+    bool hasRoom() const;
 public:
     b2BodyId bodyId;
+    body(); // constructor without a Box2D body, for pooled storage
     body(b2WorldId worldId, b2Vec2 position, float height, float width, b2BodyType type = b2_staticBody, bool collide = true, float density = 1.0f); // constructor
+    body(b2WorldId worldId, b2Vec2 position, b2BodyType type); // constructor without shapes, add them with addBox/addCircle/addCapsule
     ~body() = default; // destructor
-    b2Polygon getPolygon();
+
+    // Each returns the new shape's index, or -1 once maxBodyShapes are attached
+
+    int addBox(float height, float width, b2Vec2 center, float angle = 0.0f, bool collide = true, float density = 1.0f);
+    int addCircle(b2Vec2 center, float radius, bool collide = true, float density = 1.0f);
+    int addCapsule(b2Vec2 center1, b2Vec2 center2, float radius, bool collide = true, float density = 1.0f);
+
+    int getShapeCount() const { return shapeCount; }
+    b2ShapeId getShape(int shape = 0) const { return shapeIds[shape]; }
+    b2Polygon getPolygon(int shape = 0);
+    shapeOutline getLocalOutline(int shape = 0) const;
+
+    // Writes up to maxShapeVertices world-space vertices into out, returns the count
+    int getTransformedVertices(int shape, b2Vec2* out) const;
     std::vector<b2Vec2> getTransformedVertices();
-};
\ No newline at end of file
+};
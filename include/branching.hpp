@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "simulation.hpp"
+#include "checkpoint.hpp"
+
+struct determinismReport {
+    uint64_t stepsCompared;
+    bool freshWorldBitExact;  // restore into a newly built simulation
+    bool rewindBitExact;      // restore into the same simulation after running past the checkpoint
+    int64_t firstDivergentStep; // -1 if both runs matched
+    float maxPositionError;
+};
+
+// Runs warmupSteps (after raising the target so the drone is airborne), saves a
+// checkpoint, records compareSteps of drone state, then replays from the
+// checkpoint twice and compares every step bit for bit
+determinismReport verifyDeterminism(const simulationConfig& config, int warmupSteps = 300, int compareSteps = 600);
+
+// Forks one continuation per target altitude from a shared checkpoint and returns
+// each continuation's final state. Each worker thread builds a single simulation
+// and restores the checkpoint into it for every fork it runs.
+std::vector<bodyState> forkContinuations(const simulationConfig& config, const checkpoint& from,
+                                         const std::vector<float>& targetAltitudes, int steps,
+                                         unsigned int threadCount = 0);
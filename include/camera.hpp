@@ -0,0 +1,54 @@
+#pragma once
+
+#include <box2d/box2d.h>
+#include <SFML/Graphics.hpp>
+
+// World-to-window mapping as a plain value: uniform scale, flipped Y axis
+struct viewTransform {
+    float scale = 1.0f;    // pixels per world unit
+    float offsetX = 0.0f;  // window position of the world origin
+    float offsetY = 0.0f;
+
+    sf::Vector2f apply(float x, float y) const { return sf::Vector2f(offsetX + x * scale, offsetY - y * scale); }
+};
+
+enum class cameraMode {
+    free,  // stays where it was panned to
+    follow // eases towards the target passed to follow()
+};
+
+// A point in the world shown at the center of the viewport, at `zoom` pixels
+// per world unit. The default camera over a WxH viewport, centered on
+// (W/2, H/2) at zoom 1, is the original fixed 1:1 mapping.
+class camera {
+private:
+    b2Vec2 center;
+    float zoom;
+    cameraMode mode;
+    float followRate; // 1/s; fraction of the remaining distance closed per second is 1 - exp(-rate * dt)
+public:
+    static constexpr float minZoom = 0.01f;
+    static constexpr float maxZoom = 50.0f;
+
+    camera(b2Vec2 center = { 0.0f, 0.0f }, float zoom = 1.0f); // constructor
+
+    void setCenter(b2Vec2 center) { this->center = center; }
+    b2Vec2 getCenter() const { return center; }
+    void setZoom(float zoom);
+    float getZoom() const { return zoom; }
+    void setMode(cameraMode mode) { this->mode = mode; }
+    cameraMode getMode() const { return mode; }
+    void setFollowRate(float rate) { followRate = rate; }
+
+    // Drag by a window-space delta; switches to free mode
+    void pan(sf::Vector2f pixels);
+    // Multiplies zoom by factor, keeping the world point under `pixel` in place
+    void zoomAt(float factor, sf::Vector2f pixel, sf::Vector2u viewport);
+    // No-op unless in follow mode
+    void follow(b2Vec2 target, float dt);
+
+    viewTransform getView(sf::Vector2u viewport) const;
+    b2Vec2 toWorld(sf::Vector2f pixel, sf::Vector2u viewport) const;
+    // World rectangle covered by the viewport, grown by `marginPixels` on every side
+    b2AABB visibleBounds(sf::Vector2u viewport, float marginPixels = 0.0f) const;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <box2d/box2d.h>
+#include "controller/pid.hpp"
+#include "controller/pipeline.hpp"
+#include "controller/mppi.hpp"
+#include "controller/kind.hpp"
+#include "estimation/sensors.hpp"
+#include "estimation/estimator.hpp"
+
+struct bodyState {
+    b2Transform transform;
+    b2Vec2 linearVelocity;
+    float angularVelocity;
+    bool awake;
+};
+
+// Complete restartable state of a simulation. Box2D's contact cache is not part
+// of it, so restores are bit-exact as long as the drone's contacts match the
+// saved moment (e.g. restoring while airborne, or into a freshly built world).
+struct checkpoint {
+    uint64_t step = 0;
+    float targetAltitude = 0.0f;
+    bool controllerEnabled = true;
+    bodyState drone;
+    bodyState ground;
+    bodyState targetLine;
+    std::vector<float> thrust;
+    pid::controllerState controller;
+    pid::terms gains = {}; // altitude gains, which telemetry can change mid-run
+    control::altitudeAttitudeController cascade;
+    controllerKind activeController = controllerKind::hover;
+    control::mppiState planner;
+    estimation::imu imu;
+    estimation::barometer barometer;
+    estimation::stateEstimator estimator;
+    control::measurement lastEstimate;
+};
+
+bodyState captureBodyState(b2BodyId bodyId);
+void restoreBodyState(b2BodyId bodyId, const bodyState& state);
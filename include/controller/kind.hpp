@@ -0,0 +1,9 @@
+#pragma once
+
+enum class controllerKind {
+    hover,   // pid::hoverController, altitude only, even thrust split
+    cascade, // control::altitudeAttitudeController, altitude + attitude
+    mppi     // control::mppiController, sampling-based model-predictive control
+};
+
+const char* controllerName(controllerKind kind);
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+#include <box2d/box2d.h>
+
+namespace control {
+
+// Most rotors any airframe may have. Every fixed-size per-motor array (model,
+// recorder, telemetry) is sized by this one constant.
+constexpr int maxMixerMotors = 8;
+
+// Control allocation for one airframe. The 2 x n effectiveness matrix maps
+// motor thrusts to (collective along the mean thrust axis, torque about the
+// body origin); its pseudo-inverse is computed once, so mixing is one n x 2
+// matrix-vector product. When the result does not fit in [0, maxThrust],
+// torque is kept and collective gives way, and torque is scaled down only if
+// it cannot be met at any collective.
+class motorMixer {
+private:
+    int motorCount = 0;
+    float maxThrust = 0.0f;
+    float collectiveColumn[maxMixerMotors] = {}; // thrust per motor per newton of collective
+    float torqueColumn[maxMixerMotors] = {};     // thrust per motor per N*m of torque
+    float collectiveGain[maxMixerMotors] = {};   // collective each motor produces per newton of thrust
+
+    // Reallocates a command whose unconstrained thrusts leave [0, maxThrust]
+    void saturate(float collective, float torque, float* thrust) const;
+public:
+    motorMixer() = default;
+    motorMixer(std::span<const b2Vec2> motorPositions, std::span<const b2Vec2> motorDirections, float maxThrustPerMotor); // constructor
+
+    bool isValid() const { return motorCount > 0; }
+    int getMotorCount() const { return motorCount; }
+    bool operator==(const motorMixer& other) const;
+
+    // Writes getMotorCount() thrusts, each within [0, maxThrustPerMotor]
+    void mix(float collective, float torque, float* thrust) const;
+    // Same for many drones sharing this airframe; drone i's motors go to thrust[i * getMotorCount()].
+    // One matrix product over the whole batch, then a saturation pass over the drones that need it.
+    void mix(const float* collective, const float* torque, size_t count, float* thrust) const;
+};
+
+// count motors spread evenly over [-halfSpan, halfSpan] at the given height,
+// all thrusting along body +y; the layouts the 2-, 4-, 6- and 8-motor airframes use
+std::vector<b2Vec2> evenMotorPositions(int count, float halfSpan, float height);
+std::vector<b2Vec2> verticalMotorDirections(int count);
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "../drone.hpp"
+#include "../drone_dynamics.hpp"
+#include "pipeline.hpp"
+
+namespace control {
+
+struct mppiConfig {
+    int samples = 1024;
+    int horizon = 20;
+    float planStep = 0.075f;     // seconds per horizon step
+    float noise = 0.2f;          // thrust perturbation std dev, fraction of max thrust
+    float temperature = 0.1f;    // relative to the spread of rollout costs
+    float altitudeWeight = 1.0f;
+    float verticalVelocityWeight = 2.0f;
+    float horizontalWeight = 0.05f;
+    float horizontalVelocityWeight = 0.5f;
+    float angleWeight = 2.0e4f;
+    float angularVelocityWeight = 2.0e4f;
+    float effortWeight = 10.0f;  // on squared deviation from hover thrust, as a fraction of max
+    float terminalWeight = 10.0f;
+};
+
+// Everything that evolves between updates, so checkpoints can capture it
+struct mppiState {
+    std::vector<float> nominal; // horizon x motors
+    uint64_t iteration = 0;
+    float timeSinceShift = 0.0f;
+    float lastCost = 0.0f;
+};
+
+// Model-predictive path integral control. Each update perturbs the nominal
+// per-motor thrust plan with Gaussian noise for every sample, rolls all samples
+// out through droneModel, and moves the plan towards the noise of the cheap
+// rollouts (softmin weights). Samples are rolled out in fixed-size blocks laid
+// out as structure-of-arrays so the inner loops vectorize, and blocks are
+// spread over the shared thread pool. Noise is seeded per sample and
+// iteration, so results don't depend on the thread count.
+class mppiController {
+private:
+    drone* controlledDrone;
+    droneModel model;
+    mppiConfig config;
+    mppiState state;
+    std::vector<float> noise; // horizon x motors x samples
+    std::vector<float> costs;
+    float hoverThrust() const;
+    void sampleNoise(size_t begin, size_t end);
+    void rollout(size_t begin, size_t end, const measurement& m, const setpoint& sp);
+public:
+    mppiController(drone* controlledDrone, const mppiConfig& config = mppiConfig()); // constructor
+
+    // Plans from the measured state and applies the first step of the plan
+    void update(const measurement& m, const setpoint& sp, float dt);
+    void reset();
+    const mppiState& getState() const { return state; }
+    void setState(const mppiState& saved) { state = saved; }
+    const droneModel& getModel() const { return model; }
+    const mppiConfig& getConfig() const { return config; }
+    float getLastCost() const { return state.lastCost; }
+};
+
+}
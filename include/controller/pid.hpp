@@ -4,6 +4,19 @@
 
 namespace pid {
 
+struct terms {
+    float p;
+    float i;
+    float d;
+};
+
+// Everything that evolves between updates; gains are configuration, not state
+struct controllerState {
+    float integralError;
+    float previousError;
+    terms lastTerms;
+};
+
 class  hoverController {
 private:
     drone* controlledDrone;
@@ -12,6 +25,7 @@ private:
     float kd; // Derivative gain
     float integralError;
     float previousError;
+    terms lastTerms;
     float proportional(float error);
     float integral(float error, float deltaTime);
     float derivative(float error, float deltaTime);
@@ -19,6 +33,16 @@ private:
 public:
     hoverController(drone* controlledDrone, float kp, float ki, float kd);
     void update(float targetAltitude, float deltaTime);
+    // Uses a measured (or estimated) altitude and vertical velocity instead of
+    // the body's exact position; the derivative acts on the velocity, so noisy
+    // altitude samples are not differentiated
+    void update(float targetAltitude, float altitude, float verticalVelocity, float deltaTime);
+    const terms& getLastTerms() const { return lastTerms; }
+    controllerState getState() const { return { integralError, previousError, lastTerms }; }
+    void setState(const controllerState& state);
+    void reset(); // clears the integral, derivative history and last terms; gains are kept
+    void setGains(float kp, float ki, float kd);
+    terms getGains() const { return { kp, ki, kd }; }
 };
 
    
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include "../drone.hpp"
+
+// Controllers assembled at compile time from stages. A pipeline is a tuple of
+// stage objects; update() runs each stage in order over a shared command with a
+// fold expression, so there is no virtual dispatch and no allocation per update.
+namespace control {
+
+struct measurement {
+    float x, y, angle;
+    float velX, velY, angularVelocity;
+    float weight;
+};
+
+struct setpoint {
+    float x;
+    float altitude;
+};
+
+// Filled in stage by stage: outer loops set references for inner loops
+struct command {
+    float targetAngle;
+    float collective; // total thrust, N
+    float torque;     // N*m
+};
+
+// Anti-windup policies
+
+struct noAntiWindup {
+    float integrate(float integral, float error, float dt) const { return integral + error * dt; }
+};
+
+struct integralClamp {
+    float limit = 1000.0f;
+    float integrate(float integral, float error, float dt) const { return std::clamp(integral + error * dt, -limit, limit); }
+};
+
+// Derivative filter policies
+
+struct rawDerivative {
+    float filter(float rate) { return rate; }
+    void reset() {}
+};
+
+// First-order low-pass; alpha = 1 passes the raw derivative through
+struct lowPassDerivative {
+    float alpha = 0.5f;
+    float state = 0.0f;
+    float filter(float rate) { state += alpha * (rate - state); return state; }
+    void reset() { state = 0.0f; }
+};
+
+template <typename AntiWindup = noAntiWindup, typename DerivativeFilter = rawDerivative>
+struct pidTerm {
+    float kp = 0.0f;
+    float ki = 0.0f;
+    float kd = 0.0f;
+    AntiWindup antiWindup;
+    DerivativeFilter derivativeFilter;
+    float integral = 0.0f;
+    float previousError = 0.0f;
+    bool primed = false; // no derivative kick on the first update
+
+    float update(float error, float dt) {
+        integral = antiWindup.integrate(integral, error, dt);
+        float rate = primed ? (error - previousError) / dt : 0.0f;
+        previousError = error;
+        primed = true;
+        return kp * error + ki * integral + kd * derivativeFilter.filter(rate);
+    }
+
+    void reset() {
+        integral = 0.0f;
+        previousError = 0.0f;
+        primed = false;
+        derivativeFilter.reset();
+    }
+};
+
+// Stages
+
+// Horizontal position error -> tilt reference for the attitude loop
+template <typename Pid>
+struct horizontalStage {
+    Pid pid;
+    float maxTilt = 0.35f; // rad
+
+    void update(const measurement& m, const setpoint& sp, float dt, command& out) {
+        // Tilting clockwise (negative angle) pushes the drone towards +x
+        out.targetAngle = -std::clamp(pid.update(sp.x - m.x, dt), -maxTilt, maxTilt);
+    }
+    void reset() { pid.reset(); }
+};
+
+// Altitude error -> collective thrust, with gravity feed-forward and tilt compensation
+template <typename Pid>
+struct altitudeStage {
+    Pid pid;
+    float minTiltCosine = 0.5f;
+
+    void update(const measurement& m, const setpoint& sp, float dt, command& out) {
+        float vertical = m.weight + pid.update(sp.altitude - m.y, dt);
+        out.collective = vertical / std::max(std::cos(m.angle), minTiltCosine);
+    }
+    void reset() { pid.reset(); }
+};
+
+// Attitude error -> body torque
+template <typename Pid>
+struct attitudeStage {
+    Pid pid;
+
+    void update(const measurement& m, const setpoint&, float dt, command& out) {
+        float error = out.targetAngle - m.angle;
+        error = std::atan2(std::sin(error), std::cos(error));
+        out.torque = pid.update(error, dt);
+    }
+    void reset() { pid.reset(); }
+};
+
+struct saturationStage {
+    float maxCollective = 1.0e9f;
+    float maxTorque = 1.0e9f;
+
+    void update(const measurement&, const setpoint&, float, command& out) {
+        out.collective = std::clamp(out.collective, 0.0f, maxCollective);
+        out.torque = std::clamp(out.torque, -maxTorque, maxTorque);
+    }
+    void reset() {}
+};
+
+template <typename... Stages>
+class pipeline {
+private:
+    std::tuple<Stages...> stages;
+public:
+    pipeline() = default;
+    explicit pipeline(Stages... stages) : stages(std::move(stages)...) {}
+
+    command update(const measurement& m, const setpoint& sp, float dt) {
+        command out = { 0.0f, 0.0f, 0.0f };
+        std::apply([&](auto&... stage) { (stage.update(m, sp, dt, out), ...); }, stages);
+        return out;
+    }
+
+    void reset() {
+        std::apply([](auto&... stage) { (stage.reset(), ...); }, stages);
+    }
+
+    template <size_t I>
+    auto& stage() { return std::get<I>(stages); }
+};
+
+using filteredPid = pidTerm<integralClamp, lowPassDerivative>;
+
+// Altitude loop sets collective thrust, attitude loop holds the airframe level
+using altitudeAttitudeController = pipeline<altitudeStage<filteredPid>, attitudeStage<filteredPid>, saturationStage>;
+
+// Adds an outer horizontal position loop that commands tilt
+using positionController = pipeline<horizontalStage<filteredPid>, altitudeStage<filteredPid>, attitudeStage<filteredPid>, saturationStage>;
+
+// Glue between pipelines and a drone's Box2D body
+measurement measure(drone& d);
+// Allocates collective and torque to motors through the drone's mixer
+void applyCommand(drone& d, const command& c);
+
+}
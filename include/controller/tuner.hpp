@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include "../simulation.hpp"
+
+namespace pid {
+
+struct gains {
+    float kp;
+    float ki;
+    float kd;
+};
+
+struct tuningScenario {
+    float stepHeight = 50.0f;   // altitude change commanded at t = 0
+    float duration = 20.0f;     // simulated seconds per run
+    float settleBand = 0.02f;   // settled once |error| stays within this fraction of stepHeight
+};
+
+// Lower is better for every metric
+struct stepResponse {
+    float overshoot;     // peak overshoot as a fraction of stepHeight
+    float settlingTime;  // seconds; equals the scenario duration if never settled
+    float itae;          // integral of time-weighted absolute error
+    float saturation;    // fraction of steps with at least one motor at a thrust limit
+};
+
+struct tuningResult {
+    gains candidate;
+    stepResponse response;
+};
+
+// Runs each candidate in its own world across all cores. Worlds are independent,
+// so the only shared state is the index of the next candidate to run.
+class gainTuner {
+private:
+    simulationConfig baseConfig;
+    tuningScenario scenario;
+    unsigned int threadCount;
+public:
+    gainTuner(const simulationConfig& baseConfig, const tuningScenario& scenario = tuningScenario(), unsigned int threadCount = 0); // 0 = all cores
+    stepResponse evaluate(const gains& candidate) const;
+    std::vector<tuningResult> sweep(const std::vector<gains>& candidates) const;
+
+    static std::vector<gains> logGrid(gains low, gains high, int pointsPerAxis);
+    static std::vector<tuningResult> paretoFront(const std::vector<tuningResult>& results);
+    unsigned int getThreadCount() const { return threadCount; }
+};
+
+}
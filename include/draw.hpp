@@ -1,33 +1,125 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
+#include <optional>
 #include <box2d/box2d.h>
 #include <SFML/Graphics.hpp>
 #include "body.hpp"
+#include "camera.hpp"
+#include "entity_registry.hpp"
+
+// What the last drawShapes call actually drew
+struct drawStats {
+    size_t registered = 0; // shapes that could have been drawn
+    size_t drawn = 0;      // dynamic shapes inside the view, plus every static shape
+    size_t simplified = 0; // of those, drawn as one triangle
+    size_t vertices = 0;
+};
 
 class draw
 {
 private:
+    // One added entity. Its body id, colour and, for static bodies, transform are
+    // read once at addShape, so the render thread never calls into the registry
+    // or a world another thread is stepping.
+    struct drawnEntity {
+        entityHandle entity;
+        b2BodyId bodyId;
+        sf::Color color;
+        bool isStatic;
+        b2Transform staticTransform;
+        size_t outlineCount;
+    };
+    struct outlineInfo {
+        shapeOutline full;   // local frame
+        shapeOutline coarse; // one triangle spanning the local bounds, drawn when the shape is only a few pixels wide
+        b2Vec2 boundsCenter;
+        float boundsRadius;
+        size_t owner;
+        b2ShapeId shapeId;
+    };
+    struct visibleShape {
+        const shapeOutline* outline;
+        b2Transform transform;
+        sf::Color color;
+        size_t vertexOffset;
+    };
+
     sf::RenderWindow window;
+    std::optional<sf::RenderTexture> offscreenTarget;
+    sf::RenderTarget* target; // the window, or the offscreen texture
+    camera viewCamera;
 
     sf::Color backgroundColor;
-    sf::Color shapeColor;
-    std::vector<body*> shapes;
-    std::vector<sf::Color> shapeColors;
+    std::vector<drawnEntity> shapes; // in addShape order, which is also the layering order
+
+    // Every Box2D shape on every added entity, cached at addShape and contiguous
+    // per entity, and the lookup from a Box2D shape index to its entry for world
+    // queries. Sensor shapes are bounds-tested directly since overlap queries may skip them.
+    static constexpr uint32_t noOutline = UINT32_MAX;
+    std::vector<outlineInfo> outlines;
+    std::vector<uint32_t> outlineOfShape;
+    std::vector<size_t> sensorOutlines;
+
+    // Static shapes are triangulated once in world coordinates and drawn through
+    // the view transform, so panning costs nothing; rebuilt when one is added or
+    // the zoom changes which of them are simplified
+    std::vector<sf::Vertex> staticBatch;
+    float staticBatchScale;
+    size_t staticShapeCount;
+    size_t staticSimplified;
+    bool staticBatchDirty;
+
+    // Dynamic shapes, rebuilt every frame from what is on screen only, then drawn with one call
+    std::vector<size_t> queryHits;
+    std::vector<visibleShape> visible;
+    size_t visibleVertexCount;
+    sf::VertexArray batch;
+    drawStats lastStats;
+
+    static bool collectShape(b2ShapeId shapeId, void* context);
+    static outlineInfo makeOutlineInfo(const shapeOutline& outline, size_t owner);
+    static const shapeOutline& levelOfDetail(const outlineInfo& info, float scale, bool& simplified);
+    void drawStaticShapes(const viewTransform& view);
+    void beginVisible(size_t registered);
+    void addVisible(const outlineInfo& info, const b2Transform& transform, sf::Color color, float scale);
+    void addVisible(const shapeOutline& outline, const b2Transform& transform, sf::Color color);
+    void flushVisible();
+    static size_t writePolygon(sf::Vertex* out, size_t offset, const shapeOutline& outline, const b2Transform& transform, sf::Color color, const viewTransform& view);
 public:
-    draw(unsigned int width, unsigned int height); // constructor
+    // Shapes narrower than this many pixels are drawn as one triangle spanning their bounds
+    static constexpr float lodPixels = 3.0f;
+
+    draw(unsigned int width, unsigned int height, bool offscreen = false); // constructor; offscreen renders into a texture without opening a window
     ~draw(); // destructor
     void clear();
-    void addShape(body& shape, sf::Color* color = nullptr);
+    // Draws an entity's body in its registry colour; false if the handle is stale
+    bool addShape(const entityRegistry& entities, entityHandle entity);
+    // Stops drawing an entity; call before the registry destroys it. False if it was never added.
+    bool removeShape(entityHandle entity);
+    // Queries the bodies' world for shapes overlapping the view, so cost follows what is on screen
     void drawShapes();
+    // From snapshot transforms, one per entity in getShapes() order; culled against each shape's bounds.
+    // Static shapes use their cached transform, so they still draw if the snapshot is short.
+    void drawShapes(const std::vector<b2Transform>& transforms);
     void drawAll();
     void display();
     sf::ConvexShape convexShape(const std::vector<b2Vec2>& shape, sf::Color color);
     sf::Vector2f toWindowLocation(float x, float y);
+    viewTransform getViewTransform();
+    camera& getCamera() { return viewCamera; }
+    const drawStats& getLastStats() const { return lastStats; }
+    // The added entities in drawing order, e.g. for physicsLoop::track
+    std::vector<entityHandle> getShapes() const;
     bool isOpen();
     void close();
     std::optional<sf::Event> pollEvent();
-    
-    // Expose window for force arrow drawing
+
+    // Expose window for event handling
     sf::RenderWindow& getWindow() { return window; }
-};
\ No newline at end of file
+    // Where everything is drawn: the window, or the offscreen texture
+    sf::RenderTarget& getTarget() { return *target; }
+    const sf::Texture* getOffscreenTexture() const { return offscreenTarget ? &offscreenTarget->getTexture() : nullptr; }
+    sf::RenderTexture* getOffscreenTarget() { return offscreenTarget ? &*offscreenTarget : nullptr; }
+};
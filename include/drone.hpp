@@ -1,26 +1,42 @@
 #pragma once
 
-#include "body.hpp"
-#include <vector>
+#include <span>
+#include <box2d/box2d.h>
+#include "controller/mixer.hpp"
 
+// Motors, thrust limits and mixer of one airframe. The airframe is referred to
+// by its Box2D body id, which stops being valid when the body is destroyed, and
+// everything else is stored inline, so drones copy into pooled storage without
+// allocating.
 class drone {
     private:
-        body* droneBody;
-        std::vector<b2Vec2> motorPositions;
-        std::vector<b2Vec2> motorDirections;
-        std::vector<float> lastThrustValues;
+        b2BodyId bodyId;
+        b2Vec2 motorPositions[control::maxMixerMotors] = {};
+        b2Vec2 motorDirections[control::maxMixerMotors] = {};
+        float lastThrustValues[control::maxMixerMotors] = {};
+        int motorCount;
         float maxThrustPerMotor;
+        control::motorMixer mixer;
         void applyThrust(int motor, b2Vec2 thrustLocation, b2Vec2 thrustVec);
     public:
-        drone(body* droneBody, std::vector<b2Vec2> motorPositions, std::vector<b2Vec2> motorDirections, float maxThrustPerMotor = 1000.0f);
+        drone(); // constructor without an airframe, for pooled storage
+        drone(b2BodyId bodyId, std::span<const b2Vec2> motorPositions, std::span<const b2Vec2> motorDirections, float maxThrustPerMotor = 1000.0f);
         void applyThrust(int motor, float thrust);
+        // Same as above with the body transform already known, for callers driving several motors
+        void applyThrust(int motor, float thrust, b2Vec2 pos, b2Rot rot);
         void applyThrustEvenly(float thrust);
+        // Collective thrust and torque through the airframe's mixer, attitude first on saturation
+        void applyWrench(float collective, float torque);
         float altitude();
         float gravitationalForce();
-        float getMaxTotalThrust() const { return maxThrustPerMotor * motorPositions.size(); }
-        
-        body* getBody() const { return droneBody; }
-        const std::vector<b2Vec2>& getMotorPositions() const { return motorPositions; }
-        const std::vector<b2Vec2>& getMotorDirections() const { return motorDirections; }
-        const std::vector<float>& getLastThrustValues() const { return lastThrustValues; }
+        float getMaxTotalThrust() const { return maxThrustPerMotor * motorCount; }
+        float getMaxThrustPerMotor() const { return maxThrustPerMotor; }
+
+        b2BodyId getBodyId() const { return bodyId; }
+        int getMotorCount() const { return motorCount; }
+        std::span<const b2Vec2> getMotorPositions() const { return { motorPositions, static_cast<size_t>(motorCount) }; }
+        std::span<const b2Vec2> getMotorDirections() const { return { motorDirections, static_cast<size_t>(motorCount) }; }
+        const control::motorMixer& getMixer() const { return mixer; }
+        std::span<const float> getLastThrustValues() const { return { lastThrustValues, static_cast<size_t>(motorCount) }; }
+        void setLastThrustValues(std::span<const float> thrust);
 };
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+#include <box2d/box2d.h>
+#include "drone.hpp"
+#include "wind_field.hpp"
+
+// Planar rigid-body model of a drone: per-motor body-frame force direction and
+// torque arm, so total force and torque are linear in thrust
+struct droneModel {
+    float mass = 1.0f;
+    float inertia = 1.0f;
+    float gravity = 9.81f;
+    float maxThrustPerMotor = 0.0f;
+    int motorCount = 0;
+    float directionX[control::maxMixerMotors] = {};
+    float directionY[control::maxMixerMotors] = {};
+    float torqueArm[control::maxMixerMotors] = {}; // cross(position, direction)
+};
+
+// Motor geometry from the drone, mass properties from its Box2D body
+droneModel makeDroneModel(drone& d, float gravity = 9.81f);
+
+struct rigidBodyState {
+    b2Vec2 position;
+    b2Rot rotation;
+    b2Vec2 linearVelocity;
+    float angularVelocity;
+};
+
+// Contact-free integrator for many identical airframes, no Box2D world. State
+// and per-motor thrust are structure-of-arrays so every loop runs over drones
+// and vectorizes. Integration follows Box2D's order for a free body: forces are
+// fixed in the world frame for the whole step, then each substep updates
+// velocity, position and rotation (normalized first-order rotation update), so
+// with identical thrust the two paths agree to rounding.
+class droneDynamics {
+private:
+    droneModel model;
+    int subStepCount;
+    std::vector<float> posX, posY, rotC, rotS, velX, velY, angularVelocity;
+    std::vector<float> thrust[control::maxMixerMotors]; // one column per motor
+    std::vector<float> accelX, accelY, angularAccel; // scratch, per step
+    const windField* wind;
+    airframeDrag windDrag;
+    std::vector<float> bodyThrust, windForceX, windForceY, windTorque; // scratch, per substep
+
+    void stepInWind(float timeStep);
+public:
+    droneDynamics(const droneModel& model, int subStepCount = 4); // constructor
+    void reserve(size_t count);
+    size_t addDrone(const rigidBodyState& state);
+    size_t size() const { return posX.size(); }
+
+    // Clamped to [0, maxThrustPerMotor] like drone::applyThrust
+    void setThrust(size_t index, int motor, float value);
+    void setThrustEvenly(size_t index, float total);
+    float* thrustColumn(int motor) { return thrust[motor].data(); }
+
+    // Wind is sampled at every substep, at the substep's positions and velocities;
+    // the caller advances the field once per step. nullptr turns it off.
+    void setWind(const windField* field, const airframeDrag& airframe) { wind = field; windDrag = airframe; }
+    void step(float timeStep);
+
+    rigidBodyState getState(size_t index) const;
+    float altitude(size_t index) const { return posY[index]; }
+    float verticalVelocity(size_t index) const { return velY[index]; }
+    float weight() const { return model.mass * model.gravity; }
+    const droneModel& getModel() const { return model; }
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "simulation.hpp"
+#include "drone_dynamics.hpp"
+
+struct dynamicsValidation {
+    int steps;
+    float maxPositionError;
+    float finalPositionError;
+    float maxAngleError;      // rad
+    float maxVelocityError;
+    int firstStepOverTolerance; // -1 if the position error never exceeded the tolerance
+};
+
+// Flies the simulation's airframe well clear of the ground and the analytic
+// integrator side by side under the same open-loop per-motor thrust schedule
+// (hover thrust with a slow, different oscillation on each motor) and compares
+// the trajectories every step
+dynamicsValidation validateDynamics(const simulationConfig& config, int steps = 2000, float positionTolerance = 0.01f);
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <box2d/box2d.h>
+#include "body.hpp"
+#include "drone.hpp"
+#include "handle_pool.hpp"
+
+// One body in the world and how it is drawn
+struct entityRecord {
+    body shape;
+    uint32_t color = 0xFFFFFFFF; // RGBA, as sf::Color::toInteger()
+    entityHandle drone;          // null unless the body is a drone's airframe
+};
+
+// Owns the bodies and drones of one world. Callers keep entityHandles: a handle
+// to a destroyed entity stops resolving, and pointers from getBody()/getDrone()
+// stay valid until that entity is destroyed. Records live in pooled storage, so
+// spawning and destroying at a steady rate does not allocate, and each body's
+// slot is stored in its Box2D user data to map query results back to handles.
+class entityRegistry {
+private:
+    b2WorldId worldId;
+    handlePool<entityRecord> entities;
+    handlePool<drone> drones;
+
+    entityHandle adopt(const body& shape, uint32_t color);
+public:
+    explicit entityRegistry(b2WorldId worldId, size_t capacity = 0); // constructor
+    ~entityRegistry(); // destructor, destroys the remaining bodies if the world still exists
+    entityRegistry(const entityRegistry&) = delete;
+    entityRegistry& operator=(const entityRegistry&) = delete;
+
+    void reserve(size_t capacity);
+    // A box body, as body's box constructor builds it
+    entityHandle spawnBox(b2Vec2 position, float height, float width, b2BodyType type = b2_staticBody, bool collide = true,
+                          float density = 1.0f, uint32_t color = 0xFFFFFFFF);
+    // A dynamic box airframe and the drone that flies it
+    entityHandle spawnDrone(b2Vec2 position, float height, float width, float density, std::span<const b2Vec2> motorPositions,
+                            std::span<const b2Vec2> motorDirections, float maxThrustPerMotor, uint32_t color = 0xFFFFFFFF);
+    // Destroys the body and its drone; false if the handle is stale
+    bool destroy(entityHandle handle);
+    void clear();
+
+    bool isAlive(entityHandle handle) const { return entities.contains(handle); }
+    body* getBody(entityHandle handle);
+    const body* getBody(entityHandle handle) const;
+    drone* getDrone(entityHandle handle); // null unless the entity is a live drone
+    uint32_t getColor(entityHandle handle) const;
+    bool setColor(entityHandle handle, uint32_t color);
+    entityHandle handleOf(b2BodyId bodyId) const; // null if the body is not registered
+    b2WorldId getWorld() const { return worldId; }
+
+    // Dense passes over everything alive; positions change when an entity is destroyed
+    size_t size() const { return entities.size(); }
+    entityHandle handleAt(size_t dense) const { return entities.handleAt(dense); }
+    const entityRecord& entityAt(size_t dense) const { return entities[dense]; }
+    size_t droneCount() const { return drones.size(); }
+    drone& droneAt(size_t dense) { return drones[dense]; }
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <box2d/box2d.h>
+#include "matrix.hpp"
+#include "sensors.hpp"
+#include "../controller/pipeline.hpp"
+
+namespace estimation {
+
+struct estimatorConfig {
+    float gravity = 9.81f;
+    float accelNoise = 0.2f;     // std dev of the accelerometer, drives process noise
+    float accelBiasWalk = 0.01f; // std dev of vertical accel bias drift per sqrt(second)
+    float baroNoise = 0.5f;      // std dev of a barometer sample
+    float tiltGain = 0.5f;       // 1/s, how fast accelerometer tilt pulls the attitude estimate
+    float gyroBiasGain = 0.05f;  // 1/s, how fast the attitude residual is blamed on gyro bias
+};
+
+// Vertical channel is a Kalman filter over [altitude, vertical velocity,
+// vertical accelerometer bias] driven by the IMU and corrected by the
+// barometer; updates are scalar so no matrix inverse is needed. Attitude is a
+// complementary filter: integrated gyro, nudged towards the accelerometer's
+// gravity direction when the specific force is close to 1 g. Horizontal
+// position is dead-reckoned and drifts, since no sensor observes it.
+class stateEstimator {
+private:
+    estimatorConfig config;
+    vec<3> vertical;
+    matrix<3, 3> covariance;
+    float x;
+    float velX;
+    float angle;
+    float angularVelocity;
+    float gyroBias;
+public:
+    stateEstimator(const estimatorConfig& config = estimatorConfig()); // constructor
+    // Starts from a known state, e.g. the body on the launch pad
+    void reset(b2BodyId bodyId);
+    void predict(const imuSample& sample, float dt);
+    void correctAltitude(float measuredAltitude);
+    control::measurement estimate(float weight) const;
+    float altitudeVariance() const { return covariance(0, 0); }
+};
+
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+
+// Fixed-size row-major matrices for small filters. Storage is a flat float
+// array sized at compile time: no heap, trivially copyable, and the loops have
+// constant trip counts so the compiler can unroll and vectorize them.
+namespace estimation {
+
+template <size_t Rows, size_t Cols>
+struct matrix {
+    float m[Rows * Cols] = {};
+
+    constexpr float& operator()(size_t r, size_t c) { return m[r * Cols + c]; }
+    constexpr float operator()(size_t r, size_t c) const { return m[r * Cols + c]; }
+    constexpr float& operator[](size_t i) { return m[i]; }
+    constexpr float operator[](size_t i) const { return m[i]; }
+
+    static constexpr size_t rows() { return Rows; }
+    static constexpr size_t cols() { return Cols; }
+
+    static constexpr matrix zero() { return matrix(); }
+    static constexpr matrix identity() {
+        static_assert(Rows == Cols, "identity() needs a square matrix");
+        matrix out;
+        for (size_t i = 0; i < Rows; ++i) {
+            out(i, i) = 1.0f;
+        }
+        return out;
+    }
+
+    constexpr matrix<Cols, Rows> transposed() const {
+        matrix<Cols, Rows> out;
+        for (size_t r = 0; r < Rows; ++r) {
+            for (size_t c = 0; c < Cols; ++c) {
+                out(c, r) = (*this)(r, c);
+            }
+        }
+        return out;
+    }
+
+    constexpr matrix& operator+=(const matrix& other) {
+        for (size_t i = 0; i < Rows * Cols; ++i) {
+            m[i] += other.m[i];
+        }
+        return *this;
+    }
+    constexpr matrix& operator-=(const matrix& other) {
+        for (size_t i = 0; i < Rows * Cols; ++i) {
+            m[i] -= other.m[i];
+        }
+        return *this;
+    }
+    constexpr matrix& operator*=(float s) {
+        for (size_t i = 0; i < Rows * Cols; ++i) {
+            m[i] *= s;
+        }
+        return *this;
+    }
+};
+
+template <size_t N>
+using vec = matrix<N, 1>;
+
+template <size_t R, size_t C>
+constexpr matrix<R, C> operator+(matrix<R, C> a, const matrix<R, C>& b) { return a += b; }
+
+template <size_t R, size_t C>
+constexpr matrix<R, C> operator-(matrix<R, C> a, const matrix<R, C>& b) { return a -= b; }
+
+template <size_t R, size_t C>
+constexpr matrix<R, C> operator*(matrix<R, C> a, float s) { return a *= s; }
+
+template <size_t R, size_t C>
+constexpr matrix<R, C> operator*(float s, matrix<R, C> a) { return a *= s; }
+
+// Inner loop runs over the contiguous row of b so it vectorizes
+template <size_t R, size_t K, size_t C>
+constexpr matrix<R, C> operator*(const matrix<R, K>& a, const matrix<K, C>& b) {
+    matrix<R, C> out;
+    for (size_t r = 0; r < R; ++r) {
+        for (size_t k = 0; k < K; ++k) {
+            float s = a(r, k);
+            for (size_t c = 0; c < C; ++c) {
+                out(r, c) += s * b(k, c);
+            }
+        }
+    }
+    return out;
+}
+
+template <size_t N>
+constexpr float dot(const vec<N>& a, const vec<N>& b) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < N; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+template <size_t R, size_t C>
+constexpr bool operator==(const matrix<R, C>& a, const matrix<R, C>& b) {
+    for (size_t i = 0; i < R * C; ++i) {
+        if (a.m[i] != b.m[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert((matrix<2, 2>::identity() * matrix<2, 2>::identity()) == matrix<2, 2>::identity());
+static_assert(matrix<2, 3>().transposed().rows() == 3);
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <box2d/box2d.h>
+
+// Simulated onboard sensors sampled from a Box2D body. Every sensor is a plain
+// value type (its random generator included), so it can be copied into a
+// checkpoint and restored bit for bit.
+namespace estimation {
+
+struct noiseModel {
+    float stdDev = 0.0f;   // white noise per sample
+    float bias = 0.0f;     // constant offset at start-up
+    float biasWalk = 0.0f; // bias random walk, std dev per sqrt(second)
+    int latencySteps = 0;  // samples are delivered this many steps late
+};
+
+// xorshift64* with Box-Muller; small enough to copy with every checkpoint
+class noiseSource {
+private:
+    uint64_t state;
+    float spare;
+    bool hasSpare;
+public:
+    explicit noiseSource(uint64_t seed = 0x9E3779B97F4A7C15ull);
+    float uniform(); // (0, 1]
+    float gaussian();
+};
+
+// Roughly a hobby-grade MEMS IMU and barometer, in world units
+constexpr noiseModel defaultAccelNoise = { 0.2f, 0.05f, 0.01f, 0 };
+constexpr noiseModel defaultGyroNoise = { 0.002f, 0.001f, 0.0005f, 0 };
+constexpr noiseModel defaultBaroNoise = { 0.5f, 0.0f, 0.05f, 2 };
+
+constexpr int maxSensorLatency = 16;
+
+// Fixed ring of recent samples; no allocation
+template <typename T>
+class delayLine {
+private:
+    T samples[maxSensorLatency + 1] = {};
+    int head = 0;
+    int count = 0;
+public:
+    // Stores the newest sample and returns the one `latency` steps older
+    // (the oldest held, until enough samples have arrived)
+    T push(const T& sample, int latency) {
+        head = (head + 1) % (maxSensorLatency + 1);
+        samples[head] = sample;
+        count = count < maxSensorLatency + 1 ? count + 1 : count;
+        int delay = latency < count - 1 ? latency : count - 1;
+        delay = delay > 0 ? delay : 0;
+        return samples[(head + maxSensorLatency + 1 - delay) % (maxSensorLatency + 1)];
+    }
+};
+
+// Body-frame specific force (acceleration minus gravity) and angular rate
+struct imuSample {
+    float accelX;
+    float accelY;
+    float gyro;
+};
+
+class imu {
+private:
+    noiseModel accel;
+    noiseModel gyro;
+    noiseSource rng;
+    b2Vec2 accelBias;
+    float gyroBias;
+    b2Vec2 previousVelocity;
+    bool primed;
+    // Each channel has its own latency
+    delayLine<b2Vec2> accelDelay;
+    delayLine<float> gyroDelay;
+public:
+    imu(const noiseModel& accel = defaultAccelNoise, const noiseModel& gyro = defaultGyroNoise, uint64_t seed = 1); // constructor
+    // Acceleration is differenced from the body's velocity, so call once per step
+    imuSample sample(b2BodyId bodyId, float dt);
+};
+
+class barometer {
+private:
+    noiseModel altitude;
+    noiseSource rng;
+    float bias;
+    delayLine<float> delay;
+public:
+    barometer(const noiseModel& altitude = defaultBaroNoise, uint64_t seed = 2); // constructor
+    float sample(b2BodyId bodyId, float dt);
+};
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "mapped_file.hpp"
+#include "simulation.hpp"
+
+// One physics step. Fixed size and trivially copyable so it can be written
+// straight into the mapped ring buffer.
+struct flightRecord {
+    uint64_t step;
+    double time;
+    float posX, posY, angle;
+    float velX, velY, angularVelocity;
+    float targetAltitude;
+    float p, i, d;
+    uint32_t motorCount;
+    float thrust[control::maxMixerMotors];
+};
+
+struct flightRecordHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t capacity;
+    uint64_t written; // total records ever written; the ring holds the last min(written, capacity)
+    float timeStep;
+    uint8_t reserved[28];
+};
+static_assert(sizeof(flightRecordHeader) == 64, "records start on a cache line");
+
+// Writes records into a fixed-capacity ring buffer backed by a memory-mapped
+// file. Recording is a struct copy into mapped memory: no syscalls, no formatting.
+class flightRecorder {
+private:
+    mappedFile file;
+    flightRecordHeader* header;
+    flightRecord* records;
+public:
+    flightRecorder(); // constructor
+    bool open(const std::string& path, uint64_t capacity, float timeStep);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    void record(const flightRecord& r);
+    void record(uint64_t step, simulation& sim);
+    uint64_t getWritten() const { return header ? header->written : 0; }
+};
+
+// Read-only view of a recording, in chronological order
+class flightLog {
+private:
+    mappedFile file;
+    const flightRecordHeader* header;
+    const flightRecord* records;
+    size_t count;
+    size_t first;
+public:
+    flightLog(); // constructor
+    bool open(const std::string& path);
+
+    size_t size() const { return count; }
+    const flightRecord& at(size_t index) const { return records[(first + index) % header->capacity]; }
+    float getTimeStep() const { return header->timeStep; }
+    uint32_t getMotorCount() const { return count ? at(0).motorCount : 0; }
+
+    bool exportCsv(const std::string& path) const;
+    // Column-major binary: each field stored as one contiguous array
+    bool exportColumns(const std::string& path) const;
+};
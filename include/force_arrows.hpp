@@ -1,28 +1,54 @@
 #pragma once
 
 #include <vector>
-#include <functional>
+#include <span>
 #include <box2d/box2d.h>
 #include <SFML/Graphics.hpp>
-#include "drone.hpp"
+#include "draw.hpp"
+#include "snapshot.hpp"
+#include "swarm.hpp"
 
+// Collects force arrows for any number of drones into one triangle batch and
+// draws them with a single call. Arrows are accumulated by the add* methods
+// and submitted (and cleared) by flush().
 class ForceArrowDrawer {
 private:
     float scaleFactor;
     float arrowHeadSize;
-    
-    void drawArrow(sf::RenderWindow& window, sf::Vector2f start, sf::Vector2f end, sf::Color color);
+    sf::VertexArray batch;
+
+    void addArrow(sf::Vector2f start, sf::Vector2f end, sf::Color color);
+    void addNetForce(b2Vec2 pos, b2Vec2 netForce, const viewTransform& view,
+                     sf::Color sumColor, sf::Color vertColor, sf::Color horizColor);
 
 public:
     ForceArrowDrawer(float scaleFactor = 0.5f, float arrowHeadSize = 10.0f);
-    
-    void addNetForce(sf::RenderWindow& window,
-                     std::function<sf::Vector2f(float, float)> toWindowLocation,
-                     drone& d, body& droneBody,
+
+    void addNetForce(const droneSnapshot& d, const viewTransform& view,
                      sf::Color sumColor = sf::Color::White,
                      sf::Color vertColor = sf::Color::Green,
                      sf::Color horizColor = sf::Color::Red);
-    
+
+    void addNetForces(std::span<const droneSnapshot> drones, const viewTransform& view,
+                      sf::Color sumColor = sf::Color::White,
+                      sf::Color vertColor = sf::Color::Green,
+                      sf::Color horizColor = sf::Color::Red);
+
+    void addNetForces(const swarm& drones, const viewTransform& view,
+                      sf::Color sumColor = sf::Color::White,
+                      sf::Color vertColor = sf::Color::Green,
+                      sf::Color horizColor = sf::Color::Red);
+
+    // One arrow per motor, from the motor position along its thrust direction
+    void addMotorThrusts(std::span<const droneSnapshot> drones, const viewTransform& view,
+                         sf::Color color = sf::Color::Blue);
+
+    void addMotorThrusts(const swarm& drones, const viewTransform& view,
+                         sf::Color color = sf::Color::Blue);
+
+    void flush(sf::RenderTarget& target);
+    size_t arrowVertexCount() const { return batch.getVertexCount(); }
+
     void setScaleFactor(float scale) { scaleFactor = scale; }
     void setArrowHeadSize(float size) { arrowHeadSize = size; }
 };
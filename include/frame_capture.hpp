@@ -0,0 +1,94 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <SFML/Graphics.hpp>
+
+enum class captureFormat {
+    pngSequence, // <path>_000000.png, <path>_000001.png, ...
+    y4m          // one raw YUV 4:2:0 stream, e.g. for ffmpeg -i capture.y4m
+};
+
+struct captureConfig {
+    std::string path;
+    captureFormat format = captureFormat::pngSequence;
+    unsigned int width = 1280;
+    unsigned int height = 720;
+    unsigned int fps = 60;
+    size_t bufferCount = 8;    // CPU frames in flight between the render loop and the encoder
+    bool dropWhenBusy = false; // drop frames instead of waiting when every buffer is queued
+};
+
+struct captureStats {
+    uint64_t submitted = 0;
+    uint64_t written = 0;
+    uint64_t dropped = 0;
+    uint64_t bufferWaits = 0; // captures that had to wait for the encoder to free a buffer
+    double encodeSeconds = 0.0;
+    bool asyncReadback = false;
+};
+
+// Exports frames rendered into an sf::RenderTexture. Readback goes through a
+// small ring of OpenGL pixel-pack buffers, so a frame is copied out a couple of
+// frames after it was drawn instead of stalling the GPU; where those are not
+// available it falls back to Texture::copyToImage. Pixels land in a pool of
+// reusable buffers that a background thread encodes and writes, so the render
+// loop never touches the disk.
+class frameCapture {
+private:
+    struct frameBuffer {
+        std::vector<uint8_t> pixels; // RGBA
+        uint64_t index = 0;
+        bool bottomUp = false;       // OpenGL row order
+    };
+    struct glFunctions;
+
+    captureConfig config;
+    captureStats stats;
+    std::unique_ptr<glFunctions> gl;
+    std::vector<unsigned int> packBuffers;
+    std::deque<uint64_t> pendingReadbacks; // frame indices, oldest first
+    uint64_t nextFrame = 0;
+
+    std::mutex mutex;
+    std::condition_variable bufferFreed;
+    std::condition_variable frameQueued;
+    std::vector<std::unique_ptr<frameBuffer>> freeBuffers;
+    std::deque<std::unique_ptr<frameBuffer>> encodeQueue;
+    bool closing = false;
+    std::thread encoder;
+
+    std::ofstream stream;          // y4m output, used by the encoder thread only
+    std::vector<uint8_t> scratch;  // encoder thread only
+
+    std::unique_ptr<frameBuffer> acquireBuffer();
+    void queueFrame(std::unique_ptr<frameBuffer> frame);
+    void collectOldestReadback(sf::RenderTexture& source);
+    void encoderMain();
+    bool writePng(const frameBuffer& frame);
+    bool writeY4m(const frameBuffer& frame);
+    void releasePackBuffers();
+public:
+    frameCapture(); // constructor
+    ~frameCapture(); // destructor, finishes writing queued frames
+    frameCapture(const frameCapture&) = delete;
+    frameCapture& operator=(const frameCapture&) = delete;
+
+    bool open(const captureConfig& config);
+    // Call after source.display(); source must be config.width x config.height
+    bool capture(sf::RenderTexture& source);
+    // Reads back the frames still in flight and waits for the encoder to write them
+    void close(sf::RenderTexture& source);
+    bool isOpen() const { return encoder.joinable(); }
+    captureStats getStats();
+};
+
+// .y4m selects the raw stream, anything else is a PNG sequence prefix
+captureFormat captureFormatFor(const std::string& path);
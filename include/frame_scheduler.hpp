@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+using schedulerClock = std::chrono::steady_clock;
+
+// Typical OS sleep overshoot on a lightly loaded desktop. A larger margin is more
+// punctual under load but spends the margin of every period busy on a core.
+constexpr schedulerClock::duration defaultSpinMargin = std::chrono::microseconds(100);
+
+// Sleeps until spinMargin before the deadline, then yields until it passes.
+// A zero margin only sleeps.
+void sleepPrecise(schedulerClock::time_point deadline,
+                  schedulerClock::duration spinMargin = defaultSpinMargin);
+
+struct schedulerStats {
+    uint64_t ticks = 0;
+    uint64_t steps = 0;
+    uint64_t deadlineMisses = 0;  // ticks that started more than one period late (frames: any late frame)
+    uint64_t catchUpTicks = 0;    // ticks that ran more than one step
+    uint64_t droppedSteps = 0;    // steps discarded because the catch-up limit was hit
+    double maxStepDebt = 0.0;     // largest backlog seen at a tick, in steps
+    double totalStepDebt = 0.0;   // summed backlog, for the mean
+    double maxLatenessSeconds = 0.0;
+
+    double meanStepDebt() const { return ticks > 0 ? totalStepDebt / ticks : 0.0; }
+};
+
+// Fixed-step accumulator that keeps simulated time in step with wall-clock
+// time. Each tick returns how many steps are due; when the loop falls further
+// behind than maxStepsPerTick the excess is dropped (and counted) rather than
+// replayed in a burst.
+class fixedStepScheduler {
+private:
+    schedulerClock::duration period;
+    schedulerClock::duration spinMargin;
+    int maxStepsPerTick;
+    schedulerClock::time_point lastTick;
+    schedulerClock::duration accumulator;
+    schedulerStats stats;
+public:
+    fixedStepScheduler(double stepSeconds, int maxStepsPerTick = 4,
+                       schedulerClock::duration spinMargin = defaultSpinMargin); // constructor
+    void reset(); // restart the clock with an empty accumulator
+    int advance(); // steps due since the last call, at most maxStepsPerTick
+    void waitForNextStep() const;
+    // Fraction of a step left in the accumulator, for interpolating between states
+    double alpha() const;
+    schedulerClock::duration getPeriod() const { return period; }
+    const schedulerStats& getStats() const { return stats; }
+};
+
+// Paces a render loop to a target rate without accumulating: a late frame
+// simply starts the next period from now.
+class frameLimiter {
+private:
+    schedulerClock::duration period;
+    schedulerClock::duration spinMargin;
+    schedulerClock::time_point next;
+    schedulerStats stats;
+public:
+    frameLimiter(double rateHz, schedulerClock::duration spinMargin = defaultSpinMargin); // constructor; rateHz <= 0 disables pacing
+    void wait(); // call once per frame, after presenting
+    const schedulerStats& getStats() const { return stats; }
+};
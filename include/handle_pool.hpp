@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Reference to a pool slot. The generation changes every time the slot is
+// freed, so a handle to a destroyed item never resolves to its replacement.
+struct entityHandle {
+    static constexpr uint32_t invalidIndex = UINT32_MAX;
+
+    uint32_t index = invalidIndex;
+    uint32_t generation = 0;
+
+    bool isNull() const { return index == invalidIndex; }
+    bool operator==(const entityHandle& other) const = default;
+};
+
+// Pooled storage behind generational handles. Items sit in fixed-size pages that
+// never move, so a pointer from get() stays valid until that item is erased, and
+// the slots of live items are kept packed in one array for linear passes. Freed
+// slots are reused last in, first out, so live items stay in the low pages.
+// Erased items are parked rather than destroyed and insert() assigns over them,
+// so steady insert/erase does not allocate once the pool has grown to its
+// high-water mark. T must be default-constructible and copy-assignable.
+template <typename T>
+class handlePool {
+private:
+    static constexpr uint32_t pageSize = 256;
+    static constexpr uint32_t freeSlot = UINT32_MAX;
+
+    std::vector<std::unique_ptr<T[]>> pages;
+    std::vector<uint32_t> liveSlots;      // dense, one per live item
+    std::vector<uint32_t> slotDense;      // slot -> position in liveSlots, freeSlot when unused
+    std::vector<uint32_t> slotGeneration;
+    std::vector<uint32_t> freeSlots;
+
+    T& at(uint32_t slot) { return pages[slot / pageSize][slot % pageSize]; }
+    const T& at(uint32_t slot) const { return pages[slot / pageSize][slot % pageSize]; }
+public:
+    void reserve(size_t count) {
+        pages.reserve((count + pageSize - 1) / pageSize);
+        liveSlots.reserve(count);
+        slotDense.reserve(count);
+        slotGeneration.reserve(count);
+        freeSlots.reserve(count);
+    }
+
+    entityHandle insert(const T& item) {
+        uint32_t slot;
+        if (freeSlots.empty()) {
+            slot = static_cast<uint32_t>(slotDense.size());
+            if (slot % pageSize == 0) {
+                pages.push_back(std::make_unique<T[]>(pageSize));
+            }
+            slotDense.push_back(freeSlot);
+            slotGeneration.push_back(1);
+        } else {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        at(slot) = item;
+        slotDense[slot] = static_cast<uint32_t>(liveSlots.size());
+        liveSlots.push_back(slot);
+        return { slot, slotGeneration[slot] };
+    }
+
+    bool erase(entityHandle handle) {
+        if (!contains(handle)) {
+            return false;
+        }
+        uint32_t hole = slotDense[handle.index];
+        uint32_t last = liveSlots.back();
+        liveSlots[hole] = last;
+        slotDense[last] = hole;
+        liveSlots.pop_back();
+        slotDense[handle.index] = freeSlot;
+        ++slotGeneration[handle.index];
+        freeSlots.push_back(handle.index);
+        return true;
+    }
+
+    void clear() {
+        for (uint32_t slot : liveSlots) {
+            slotDense[slot] = freeSlot;
+            ++slotGeneration[slot];
+            freeSlots.push_back(slot);
+        }
+        liveSlots.clear();
+    }
+
+    bool contains(entityHandle handle) const {
+        return handle.index < slotDense.size() && slotDense[handle.index] != freeSlot && slotGeneration[handle.index] == handle.generation;
+    }
+
+    T* get(entityHandle handle) { return contains(handle) ? &at(handle.index) : nullptr; }
+    const T* get(entityHandle handle) const { return contains(handle) ? &at(handle.index) : nullptr; }
+
+    // Current handle of whatever lives in a slot, null if the slot is free
+    entityHandle handleOfSlot(uint32_t slot) const {
+        if (slot >= slotDense.size() || slotDense[slot] == freeSlot) {
+            return {};
+        }
+        return { slot, slotGeneration[slot] };
+    }
+
+    // Dense access for linear passes; positions change when items are erased
+    size_t size() const { return liveSlots.size(); }
+    T& operator[](size_t dense) { return at(liveSlots[dense]); }
+    const T& operator[](size_t dense) const { return at(liveSlots[dense]); }
+    entityHandle handleAt(size_t dense) const { uint32_t slot = liveSlots[dense]; return { slot, slotGeneration[slot] }; }
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// A file mapped into memory. Writable mappings are created (or truncated) at a
+// fixed size; read-only mappings cover the whole existing file.
+class mappedFile {
+private:
+    void* data;
+    size_t size;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+public:
+    mappedFile(); // constructor
+    ~mappedFile(); // destructor
+    mappedFile(const mappedFile&) = delete;
+    mappedFile& operator=(const mappedFile&) = delete;
+
+    bool create(const std::string& path, size_t size);
+    bool openReadOnly(const std::string& path);
+    void close();
+
+    bool isOpen() const { return data != nullptr; }
+    void* getData() const { return data; }
+    size_t getSize() const { return size; }
+};
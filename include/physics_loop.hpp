@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "simulation.hpp"
+#include "snapshot.hpp"
+#include "triple_buffer.hpp"
+#include "flight_recorder.hpp"
+#include "frame_scheduler.hpp"
+
+// Called on the physics thread after every step, before the next one; must not block
+class stepObserver {
+public:
+    virtual ~stepObserver() = default;
+    virtual void afterStep(uint64_t step, simulation& sim) = 0;
+};
+
+// Runs control and physics on a dedicated thread at a fixed rate and publishes a
+// worldSnapshot after every wake-up that ran at least one step; the snapshot's
+// step count says how many steps it advanced. Other threads only talk to it through atomics
+// and the snapshot buffer, so render cost never delays the controller.
+class physicsLoop {
+private:
+    simulation& sim;
+    float rateHz;
+    std::vector<entityHandle> tracked;
+    flightRecorder* recorder;
+    stepObserver* observer;
+    tripleBuffer<worldSnapshot> snapshots;
+    std::thread worker;
+    std::atomic<bool> running;
+    std::atomic<float> requestedTarget;
+    std::atomic<bool> requestedEnabled;
+    std::atomic<controllerKind> requestedController;
+    fixedStepScheduler scheduler;
+
+    void run();
+    void publish(uint64_t step);
+public:
+    physicsLoop(simulation& sim, float rateHz = 240.0f, int maxCatchUpSteps = 4,
+                schedulerClock::duration spinMargin = defaultSpinMargin); // constructor
+    ~physicsLoop(); // destructor
+    physicsLoop(const physicsLoop&) = delete;
+    physicsLoop& operator=(const physicsLoop&) = delete;
+
+    // Register entities of the simulation whose transforms are copied into every snapshot; call before start()
+    void track(entityHandle entity);
+    // Record every step from the physics thread; call before start()
+    void setRecorder(flightRecorder* recorder) { this->recorder = recorder; }
+    // Call before start()
+    void setObserver(stepObserver* observer) { this->observer = observer; }
+    void start();
+    void stop();
+
+    void setTargetAltitude(float altitude) { requestedTarget.store(altitude, std::memory_order_relaxed); }
+    float getTargetAltitude() const { return requestedTarget.load(std::memory_order_relaxed); }
+    void setControllerEnabled(bool enabled) { requestedEnabled.store(enabled, std::memory_order_relaxed); }
+    bool isControllerEnabled() const { return requestedEnabled.load(std::memory_order_relaxed); }
+    void setControllerKind(controllerKind kind) { requestedController.store(kind, std::memory_order_relaxed); }
+    controllerKind getControllerKind() const { return requestedController.load(std::memory_order_relaxed); }
+    float getRate() const { return rateHz; }
+    // Owned by the physics thread; read only after stop()
+    const schedulerStats& getSchedulerStats() const { return scheduler.getStats(); }
+
+    // Consumer side of the snapshot buffer; only one thread may call these
+    bool update() { return snapshots.update(); }
+    const worldSnapshot& latest() const { return snapshots.readBuffer(); }
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Scoped timing zones with per-thread ring buffers. When DRONE_CONTROL_PROFILING
+// is not defined, PROFILE_ZONE expands to nothing and the hot paths carry no cost.
+namespace profiling {
+
+struct zoneEvent {
+    const char* name; // must be a string literal; zones are grouped by pointer
+    uint64_t startNs;
+    uint64_t durationNs;
+};
+
+struct capturedEvent {
+    zoneEvent event;
+    uint32_t threadIndex;
+};
+
+struct zoneStats {
+    const char* name;
+    size_t count;
+    double p50Us;
+    double p99Us;
+};
+
+inline uint64_t nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Lock-free for the owning thread. Each slot is a small seqlock: its sequence is
+// cleared while the event is written and then set to the event's index plus one,
+// so a reader on another thread can tell a slot it read mid-write and skip it.
+class threadBuffer {
+public:
+    static constexpr size_t capacity = 1 << 13;
+private:
+    struct slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> startNs{0};
+        std::atomic<uint64_t> durationNs{0};
+    };
+    slot slots[capacity];
+    std::atomic<uint64_t> head;
+    uint32_t threadIndex;
+public:
+    threadBuffer(uint32_t threadIndex) : head(0), threadIndex(threadIndex) {}
+    void push(const char* name, uint64_t startNs, uint64_t endNs) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        slot& s = slots[h & (capacity - 1)];
+        s.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        s.name.store(name, std::memory_order_relaxed);
+        s.startNs.store(startNs, std::memory_order_relaxed);
+        s.durationNs.store(endNs - startNs, std::memory_order_relaxed);
+        s.sequence.store(h + 1, std::memory_order_release);
+        head.store(h + 1, std::memory_order_release);
+    }
+    // Appends up to maxEvents of the most recent events. The owner may keep
+    // writing; slots it rewrote during the copy are dropped.
+    void copyRecent(size_t maxEvents, std::vector<capturedEvent>& out) const;
+    uint32_t getThreadIndex() const { return threadIndex; }
+    // Hands a retired buffer to a new thread; only while no thread owns it
+    void reset(uint32_t threadIndex);
+};
+
+// The calling thread's buffer, taken on first use and retired when the thread
+// exits. Retired buffers keep their events until a new thread reuses them, so
+// memory is bounded by the most threads that were ever recording at once.
+threadBuffer& localBuffer();
+
+class scopedZone {
+private:
+    const char* name;
+    uint64_t startNs;
+public:
+    explicit scopedZone(const char* name) : name(name), startNs(nowNs()) {}
+    ~scopedZone() { localBuffer().push(name, startNs, nowNs()); }
+    scopedZone(const scopedZone&) = delete;
+    scopedZone& operator=(const scopedZone&) = delete;
+};
+
+// Most recent events from every thread that has recorded a zone
+std::vector<capturedEvent> capture(size_t maxEventsPerThread = threadBuffer::capacity);
+// Rolling percentiles per zone over the most recent events
+std::vector<zoneStats> summarize(size_t recentEventsPerThread = 4096);
+// Chrome trace / Perfetto JSON ("X" complete events, microsecond timestamps)
+bool writeChromeTrace(const std::string& path);
+
+}
+
+#ifdef DRONE_CONTROL_PROFILING
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ::profiling::scopedZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#endif
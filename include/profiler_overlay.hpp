@@ -0,0 +1,24 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include "profiler.hpp"
+
+// On-screen table of rolling p50/p99 per profiling zone, with a bar per zone
+// (p50 solid, p99 tick). Statistics are refreshed a few times per second.
+class ProfilerOverlay {
+private:
+    sf::VertexArray batch;
+    std::vector<profiling::zoneStats> stats;
+    std::chrono::steady_clock::time_point lastRefresh;
+    std::chrono::milliseconds refreshInterval;
+    bool visible;
+    void rebuild();
+public:
+    ProfilerOverlay(std::chrono::milliseconds refreshInterval = std::chrono::milliseconds(250));
+    void setVisible(bool visible) { this->visible = visible; }
+    bool isVisible() const { return visible; }
+    void update();
+    void draw(sf::RenderTarget& target);
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <optional>
+#include <box2d/box2d.h>
+#include "body.hpp"
+#include "drone.hpp"
+#include "entity_registry.hpp"
+#include "controller/pid.hpp"
+#include "controller/pipeline.hpp"
+#include "controller/mppi.hpp"
+#include "controller/kind.hpp"
+#include "estimation/sensors.hpp"
+#include "estimation/estimator.hpp"
+#include "checkpoint.hpp"
+#include "wind_field.hpp"
+
+struct simulationConfig {
+    float worldWidth = 800.0f;
+    float worldHeight = 600.0f;
+    // Defaults match src/assets/drone.png (616x182) at the 0.15 sprite scale,
+    // so headless runs build the same airframe as the windowed front end
+    float droneWidth = 616.0f * 0.15f;
+    float droneHeight = 182.0f * 0.15f;
+    float maxThrustPerMotor = 20000.0f;
+    int motorCount = 2; // spread evenly along the airframe, 1 to control::maxMixerMotors
+    float kp = 1.0f;
+    float ki = 0.0005f;
+    float kd = 200.0f;
+    float timeStep = 1.0f / 30.0f;
+    int subStepCount = 6;
+    controllerKind controller = controllerKind::hover;
+    // Step Box2D on the shared thread pool. Leave off for worlds that are
+    // themselves stepped inside pool tasks (tuner, forks).
+    bool multithreadedPhysics = false;
+    // Controllers read the state estimator fed by simulated IMU and barometer
+    // instead of the exact Box2D state
+    bool useEstimator = false;
+    estimation::noiseModel accelNoise = estimation::defaultAccelNoise;
+    estimation::noiseModel gyroNoise = estimation::defaultGyroNoise;
+    estimation::noiseModel baroNoise = estimation::defaultBaroNoise;
+    uint64_t sensorSeed = 1;
+    // Wind and gusts; the grid is laid over the world at wind.cellSize
+    bool enableWind = false;
+    windConfig wind;
+    // Rotor thrust gain near the ground, independent of the wind
+    bool groundEffect = false;
+};
+
+// Drag of the airframe described by config.droneWidth and droneHeight
+airframeDrag airframeDragFor(const simulationConfig& config);
+
+// Owns the Box2D world and the drone scene (ground, drone, target marker, controller).
+// Contains no rendering code so it can run without a display.
+class simulation {
+private:
+    simulationConfig config;
+    b2WorldId worldId;
+    // The scene's bodies and drone; the controllers keep the drone's pointer,
+    // which pooled storage keeps valid for as long as the entity lives
+    entityRegistry entities;
+    entityHandle droneEntity;
+    entityHandle groundEntity;
+    entityHandle targetEntity;
+    pid::hoverController hover;
+    control::altitudeAttitudeController cascade;
+    control::mppiController planner;
+    estimation::imu imuSensor;
+    estimation::barometer baro;
+    estimation::stateEstimator estimator;
+    control::measurement lastEstimate;
+    std::optional<windField> wind; // only built when enabled, the grid is large
+    airframeDrag drag;
+    float targetAltitude;
+    bool controllerEnabled;
+    uint64_t stepCount;
+
+    void applyAirLoads();
+public:
+    simulation(const simulationConfig& config = simulationConfig()); // constructor
+    ~simulation(); // destructor
+    simulation(const simulation&) = delete;
+    simulation& operator=(const simulation&) = delete;
+
+    void step();
+    uint64_t getStepCount() const { return stepCount; }
+
+    // Restoring reuses the checkpoint's and the world's storage, so it is cheap
+    // enough to fork many continuations from one saved state
+    void saveCheckpoint(checkpoint& out);
+    void restoreCheckpoint(const checkpoint& saved);
+    void setTargetAltitude(float altitude);
+    float getTargetAltitude() const { return targetAltitude; }
+    void setControllerEnabled(bool enabled) { controllerEnabled = enabled; }
+    bool isControllerEnabled() const { return controllerEnabled; }
+    // Switches controllers between steps; the newly selected one starts from reset
+    void setControllerKind(controllerKind kind);
+    controllerKind getControllerKind() const { return config.controller; }
+    // Altitude PID gains, shared by the hover controller and the cascade's altitude stage
+    void setAltitudeGains(float kp, float ki, float kd);
+
+    b2WorldId getWorld() const { return worldId; }
+    entityRegistry& getEntities() { return entities; }
+    const entityRegistry& getEntities() const { return entities; }
+    entityHandle getDroneEntity() const { return droneEntity; }
+    entityHandle getGroundEntity() const { return groundEntity; }
+    entityHandle getTargetEntity() const { return targetEntity; }
+    body& getDroneBody() { return *entities.getBody(droneEntity); }
+    body& getGround() { return *entities.getBody(groundEntity); }
+    body& getTargetLine() { return *entities.getBody(targetEntity); }
+    drone& getDrone() { return *entities.getDrone(droneEntity); }
+    pid::hoverController& getController() { return hover; }
+    control::altitudeAttitudeController& getCascade() { return cascade; }
+    control::mppiController& getPlanner() { return planner; }
+    // Most recent estimator output; only updated when useEstimator is set
+    const control::measurement& getEstimate() const { return lastEstimate; }
+    // Null unless config.enableWind
+    const windField* getWind() const { return wind ? &*wind : nullptr; }
+    const airframeDrag& getDrag() const { return drag; }
+    const simulationConfig& getConfig() const { return config; }
+};
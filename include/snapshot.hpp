@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <box2d/box2d.h>
+#include "drone.hpp"
+#include "entity_registry.hpp"
+
+// Plain copies of simulation state that a renderer can read without touching Box2D
+// Value-initialized, so a snapshot that was never captured still reads as a drone at rest
+struct droneSnapshot {
+    b2Transform transform = { { 0.0f, 0.0f }, { 1.0f, 0.0f } };
+    b2Vec2 linearVelocity = { 0.0f, 0.0f };
+    float angularVelocity = 0.0f;
+    float weight = 0.0f;
+    std::vector<b2Vec2> motorPositions;
+    std::vector<b2Vec2> motorDirections;
+    std::vector<float> thrust;
+};
+
+struct worldSnapshot {
+    uint64_t step = 0;
+    double time = 0.0;
+    float targetAltitude = 0.0f;
+    bool controllerEnabled = false;
+    std::vector<b2Transform> bodyTransforms; // in the order entities were tracked
+    droneSnapshot droneState;
+};
+
+// Both reuse the destination's storage, so steady-state capture doesn't allocate.
+// An entity that no longer exists reads as the identity transform.
+void captureDrone(drone& d, droneSnapshot& out);
+void captureBodies(const entityRegistry& entities, const std::vector<entityHandle>& tracked, std::vector<b2Transform>& out);
+
+b2Transform interpolate(const b2Transform& a, const b2Transform& b, float alpha);
+void interpolate(const worldSnapshot& a, const worldSnapshot& b, float alpha, worldSnapshot& out);
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <SFML/Graphics.hpp>
+
+// Several images packed into one texture, each addressed by a region index.
+// Regions are padded with copies of their edge pixels, so smoothing and the
+// smaller mipmap levels never blend in a neighbour.
+class spriteAtlas {
+private:
+    std::vector<std::string> names;
+    std::vector<sf::Image> images; // until build()
+    std::vector<sf::IntRect> regions;
+    sf::Texture texture;
+public:
+    static constexpr unsigned int padding = 8;
+
+    // Queues an image and returns its region index, usable once build() succeeds
+    size_t add(const std::string& name, const sf::Image& image);
+    // Shelf-packs every queued image into one smoothed, mipmapped texture
+    bool build();
+
+    size_t find(const std::string& name) const; // SIZE_MAX if there is no such region
+    size_t size() const { return regions.size(); }
+    const std::string& getName(size_t index) const { return names[index]; }
+    sf::IntRect getRegion(size_t index) const { return regions[index]; }
+    const sf::Texture& getTexture() const { return texture; }
+};
+
+// Textured quads from one atlas, collected over a frame and drawn with a single call
+class spriteBatch {
+private:
+    const spriteAtlas* atlas;
+    std::vector<sf::Vertex> vertices;
+public:
+    explicit spriteBatch(const spriteAtlas& atlas); // constructor
+
+    // Region centered on `position` in window pixels, rotated clockwise on screen
+    // like sf::Sprite::setRotation, `scale` times the region's pixel size
+    void add(size_t region, sf::Vector2f position, sf::Angle rotation, float scale, sf::Color tint = sf::Color::White);
+    size_t size() const { return vertices.size() / 6; }
+    // Draws everything added since the last flush, then starts over
+    void flush(sf::RenderTarget& target);
+};
+
+// The airframe skins: the embedded drone.png plus recoloured copies of it.
+// Returns how many were added to the atlas.
+size_t addDroneSkins(spriteAtlas& atlas);
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <span>
+#include <box2d/box2d.h>
+#include "drone.hpp"
+#include "controller/mixer.hpp"
+#include "wind_field.hpp"
+
+// Structure-of-arrays container for many drones sharing one world.
+// Motor layouts, commands and per-step transforms live in contiguous arrays so
+// thrust for every motor is computed in a single pass, and each drone receives
+// one force + one torque instead of a Box2D call per motor.
+class swarm {
+private:
+    // Per drone
+    std::vector<b2BodyId> bodies;
+    std::vector<uint32_t> motorBegin;
+    std::vector<uint32_t> motorEnd;
+    std::vector<float> localCenterX, localCenterY;
+    std::vector<float> mass;
+    std::vector<float> posX, posY, rotC, rotS;
+    std::vector<float> velX, velY;
+    std::vector<uint32_t> mixerIndex;
+    // One mixer per distinct airframe, shared by every drone built the same way
+    std::vector<control::motorMixer> mixers;
+
+    // Per motor
+    std::vector<float> motorPosX, motorPosY;
+    std::vector<float> motorDirX, motorDirY;
+    std::vector<float> maxThrust;
+    std::vector<float> command;
+    std::vector<float> lastThrust;
+    // Owning drone's transform broadcast per motor, so the thrust pass has no gathers
+    std::vector<float> motorRotC, motorRotS;
+    std::vector<float> forceX, forceY;
+    std::vector<float> armX, armY;
+
+    // Optional disturbance, loads per drone
+    const windField* wind = nullptr;
+    airframeDrag windDrag;
+    std::vector<float> bodyThrust;
+    std::vector<float> windForceX, windForceY, windTorque;
+
+    void computeThrust();
+    void computeWind();
+    void applyForces();
+public:
+    swarm() = default;
+    void reserve(size_t drones, size_t motorsPerDrone);
+    size_t addDrone(b2BodyId bodyId, std::span<const b2Vec2> motorPositions, std::span<const b2Vec2> motorDirections, float maxThrustPerMotor = 1000.0f);
+    size_t addDrone(const drone& d);
+
+    void setThrust(size_t index, size_t motor, float thrust);
+    void setThrustEvenly(size_t index, float thrust);
+    void setWrench(size_t index, float collective, float torque);
+    // Collective and torque for every drone, mixed in runs of drones sharing an airframe
+    void setWrenches(const float* collective, const float* torque);
+    // Call once per step before reading state or setting commands
+    void syncState();
+    // Computes every motor's thrust and applies the forces; call before b2World_Step
+    void applyCommands();
+    // Adds wind drag and ground effect to every drone in applyCommands, folded into
+    // the same force and torque; the caller advances the field. nullptr turns it off.
+    void setWind(const windField* field, const airframeDrag& airframe) { wind = field; windDrag = airframe; }
+
+    size_t size() const { return bodies.size(); }
+    size_t motorCount() const { return motorPosX.size(); }
+    size_t motorCount(size_t index) const { return motorEnd[index] - motorBegin[index]; }
+    b2BodyId getBody(size_t index) const { return bodies[index]; }
+    float getMass(size_t index) const { return mass[index]; }
+    float gravitationalForce(size_t index) const { return mass[index] * 9.81f; }
+    float getMaxTotalThrust(size_t index) const;
+    b2Vec2 getMotorPosition(size_t index, size_t motor) const { size_t m = motorBegin[index] + motor; return { motorPosX[m], motorPosY[m] }; }
+    b2Vec2 getMotorDirection(size_t index, size_t motor) const { size_t m = motorBegin[index] + motor; return { motorDirX[m], motorDirY[m] }; }
+
+    // Values cached by the last syncState()
+    float altitude(size_t index) const { return posY[index]; }
+    b2Vec2 getPosition(size_t index) const { return { posX[index], posY[index] }; }
+    b2Rot getRotation(size_t index) const { return { rotC[index], rotS[index] }; }
+    b2Vec2 getLinearVelocity(size_t index) const { return { velX[index], velY[index] }; }
+    const float* getLastThrustValues(size_t index) const { return lastThrust.data() + motorBegin[index]; }
+};
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include <SFML/Network.hpp>
+#include "physics_loop.hpp"
+
+// Wire format, all fields little-endian. Every datagram starts with a
+// telemetry::header followed by `count` records of its type. The sender's
+// steady-clock time lets a client on the same host measure one-way latency;
+// the echoed command sequence and timestamp give round-trip time from anywhere.
+namespace telemetry {
+
+constexpr uint32_t magic = 0x4D544E44; // "DNTM"
+constexpr uint8_t version = 1;
+constexpr unsigned short defaultPort = 47800;
+// Stays under a typical Ethernet MTU so batches are never fragmented
+constexpr size_t maxDatagramSize = 1200;
+
+enum class packetType : uint8_t {
+    state = 1,   // server -> client, stateRecord batch
+    command = 2  // client -> server, commandRecord batch
+};
+
+enum class commandType : uint8_t {
+    hello = 0,      // subscribe the sender to the telemetry stream
+    setpoint = 1,   // a = altitude
+    gains = 2,      // a, b, c = kp, ki, kd
+    enable = 3,     // a != 0 enables the controller
+    controller = 4  // a = controllerKind
+};
+
+struct header {
+    uint8_t type;
+    uint16_t count;
+    uint32_t sequence;     // per sender, +1 per datagram
+    uint64_t sentNanos;    // sender steady clock
+    uint32_t ackSequence;  // last command datagram the server received
+    uint64_t ackNanos;     // that datagram's sentNanos, on the client's clock
+};
+constexpr size_t headerSize = 4 + 1 + 1 + 2 + 4 + 8 + 4 + 8;
+
+struct stateRecord {
+    uint32_t step;
+    float time;
+    float x, y, angle;
+    float velX, velY, angularVelocity;
+    float targetAltitude;
+    float altitudeError; // target - altitude
+    uint8_t motorCount;
+    float thrust[control::maxMixerMotors];
+};
+constexpr size_t stateRecordSize(int motorCount) { return 4 + 9 * 4 + 1 + 4 * static_cast<size_t>(motorCount); }
+
+struct commandRecord {
+    commandType type;
+    float a = 0.0f;
+    float b = 0.0f;
+    float c = 0.0f;
+};
+constexpr size_t commandRecordSize = 1 + 3 * 4;
+
+uint64_t nowNanos();
+
+// Records are appended to `out`; the header is written in place over the
+// first headerSize bytes once the count is known. Decoding returns false on
+// anything malformed.
+void writeHeader(uint8_t* out, const header& h);
+void writeState(std::vector<uint8_t>& out, const stateRecord& r);
+void writeCommand(std::vector<uint8_t>& out, const commandRecord& c);
+bool readHeader(const uint8_t* data, size_t size, header& h);
+// Reads the record at `offset` and advances it
+bool readState(const uint8_t* data, size_t size, size_t& offset, stateRecord& r);
+bool readCommand(const uint8_t* data, size_t size, size_t& offset, commandRecord& c);
+
+stateRecord captureState(uint64_t step, simulation& sim);
+
+}
+
+struct telemetryConfig {
+    unsigned short port = telemetry::defaultPort; // commands are received here
+    // Fixed destination for the stream, and the only host whose commands are
+    // accepted; without one, the first client to send a command becomes both
+    std::optional<sf::IpAddress> peer;
+    unsigned short peerPort = 0;
+    int batch = 4;      // steps per datagram, bounded by maxDatagramSize
+    int decimation = 1; // stream every Nth step
+};
+
+struct telemetryServerStats {
+    uint64_t records = 0;
+    uint64_t datagrams = 0;
+    uint64_t sendFailures = 0; // datagrams dropped because the socket was not ready
+    uint64_t commands = 0;
+    uint64_t rejected = 0;     // malformed datagrams, or commands from anyone but the peer
+};
+
+// Streams the simulation state over UDP and applies commands sent back. Runs on
+// the physics thread as a stepObserver; the socket is non-blocking so a slow or
+// absent receiver costs a failed send, never a late step. With a physicsLoop,
+// setpoints go through its atomics like the keyboard's; without one (headless)
+// they are applied to the simulation directly.
+class telemetryServer : public stepObserver {
+private:
+    telemetryConfig config;
+    sf::UdpSocket socket;
+    physicsLoop* loop;
+    std::optional<sf::IpAddress> peer;
+    unsigned short peerPort;
+    std::optional<sf::IpAddress> commandSender; // source of the last command datagram
+    unsigned short commandPort;
+    std::vector<uint8_t> datagram;
+    int pending;
+    uint32_t sequence;
+    uint32_t ackSequence;
+    uint64_t ackNanos;
+    telemetryServerStats stats;
+    uint8_t receiveBuffer[telemetry::maxDatagramSize];
+
+    void pollCommands(simulation& sim);
+    void apply(const telemetry::commandRecord& command, simulation& sim);
+    void beginDatagram();
+public:
+    telemetryServer(); // constructor
+    telemetryServer(const telemetryServer&) = delete;
+    telemetryServer& operator=(const telemetryServer&) = delete;
+
+    bool open(const telemetryConfig& config, physicsLoop* loop = nullptr);
+    void afterStep(uint64_t step, simulation& sim) override;
+    // Sends a partial batch now
+    void flush();
+    unsigned short getPort() const { return socket.getLocalPort(); }
+    // Owned by the physics thread; read only after it stopped
+    const telemetryServerStats& getStats() const { return stats; }
+};
+
+struct telemetryClientStats {
+    uint64_t datagrams = 0;
+    uint64_t records = 0;
+    uint64_t lost = 0;       // sequence gaps not filled later
+    uint64_t reordered = 0;  // arrived after a later datagram
+    uint64_t duplicates = 0;
+    uint64_t rejected = 0;
+    std::vector<double> latencySeconds; // send -> receive, same host only
+    std::vector<double> roundTripSeconds; // command -> first telemetry acknowledging it
+};
+
+// The other end of the link, used by ground tools and the loopback test
+class telemetryClient {
+private:
+    sf::UdpSocket socket;
+    sf::IpAddress server;
+    unsigned short serverPort;
+    uint32_t sequence;
+    uint32_t highestSequence;
+    bool received;
+    uint32_t lastAck;
+    std::vector<uint32_t> missing; // gaps still expected to arrive late
+    std::vector<uint8_t> datagram;
+    telemetryClientStats stats;
+    uint8_t receiveBuffer[telemetry::maxDatagramSize];
+
+    void track(uint32_t sequence);
+public:
+    telemetryClient(); // constructor
+    telemetryClient(const telemetryClient&) = delete;
+    telemetryClient& operator=(const telemetryClient&) = delete;
+
+    bool open(sf::IpAddress server, unsigned short serverPort);
+    bool send(const std::vector<telemetry::commandRecord>& commands);
+    bool send(const telemetry::commandRecord& command) { return send(std::vector<telemetry::commandRecord>{ command }); }
+    // Drains every datagram already queued without blocking; returns the records received
+    size_t poll(std::vector<telemetry::stateRecord>* out = nullptr);
+    const telemetryClientStats& getStats() const { return stats; }
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <box2d/box2d.h>
+
+struct threadPoolConfig {
+    unsigned int threads = 0;   // threads doing work, the caller included; 0 = all cores
+    bool pinThreads = false;    // pin worker i to core (firstCore + i) % cores, where supported
+    unsigned int firstCore = 0;
+};
+
+// Work-stealing pool: every worker owns a queue, threads outside the pool push
+// to a shared one, and idle workers steal from the others. Waiting threads
+// help run queued tasks of the group they wait on instead of blocking, so
+// parallel sections may nest. They never pick up unrelated work, so a wait
+// inside a controller is not stretched by, say, a whole forked run.
+//
+// It also backs Box2D's task system (attach()). Box2D's solver tasks spin on
+// one another, so queues are FIFO, and since a thread outside the pool only
+// helps with its own group, the pool's workers plus one outside thread per
+// world map onto Box2D worker indices without sharing one. Worlds stepped
+// from inside pool tasks should not be attached to the same pool.
+class threadPool {
+public:
+    using taskFn = void (*)(void* context, size_t begin, size_t end, uint32_t workerIndex);
+
+    struct taskGroup {
+        std::atomic<size_t> pending{0};
+    };
+
+private:
+    struct task {
+        taskFn fn;
+        void* context;
+        size_t begin;
+        size_t end;
+        taskGroup* group;
+    };
+    struct alignas(64) taskQueue {
+        std::mutex mutex;
+        std::deque<task> tasks;
+    };
+    struct box2dTask {
+        taskGroup group;
+        b2TaskCallback* callback;
+        void* context;
+    };
+
+    threadPoolConfig config;
+    std::vector<std::unique_ptr<taskQueue>> queues; // one per worker, then the shared queue
+    std::vector<std::thread> workers;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> sleepers{0};
+    std::atomic<bool> stopping{false};
+    bool pinned;
+
+    std::mutex box2dMutex;
+    std::vector<std::unique_ptr<box2dTask>> box2dFree;
+
+    uint32_t currentWorker() const;
+    bool tryRunOne(uint32_t self, const taskGroup* onlyGroup);
+    void workerMain(uint32_t index);
+    static void runBox2dChunk(void* context, size_t begin, size_t end, uint32_t workerIndex);
+    static void* enqueueBox2dTask(b2TaskCallback* task, int itemCount, int minRange, void* taskContext, void* userContext);
+    static void finishBox2dTask(void* userTask, void* userContext);
+public:
+    explicit threadPool(const threadPoolConfig& config = threadPoolConfig()); // constructor
+    ~threadPool(); // destructor
+    threadPool(const threadPool&) = delete;
+    threadPool& operator=(const threadPool&) = delete;
+
+    uint32_t workerCount() const { return static_cast<uint32_t>(workers.size()); }
+    uint32_t concurrency() const { return workerCount() + 1; } // workers plus the calling thread
+    bool isPinned() const { return pinned; }
+
+    void submit(taskGroup& group, taskFn fn, void* context, size_t begin, size_t end);
+    void wait(taskGroup& group);
+
+    // Runs body(begin, end) over [0, count) in chunks of at least grain items;
+    // the calling thread takes the first chunk and helps until all are done
+    template <typename F>
+    void parallelFor(size_t count, size_t grain, F&& body) {
+        if (count == 0) {
+            return;
+        }
+        size_t maxChunks = static_cast<size_t>(concurrency()) * 4;
+        grain = std::max({ grain, size_t(1), (count + maxChunks - 1) / maxChunks });
+        if (workers.empty() || grain >= count) {
+            body(size_t(0), count);
+            return;
+        }
+        using bodyType = std::remove_reference_t<F>;
+        taskFn trampoline = [](void* context, size_t begin, size_t end, uint32_t) {
+            (*static_cast<bodyType*>(context))(begin, end);
+        };
+        taskGroup group;
+        for (size_t begin = grain; begin < count; begin += grain) {
+            submit(group, trampoline, const_cast<void*>(static_cast<const void*>(&body)), begin, std::min(begin + grain, count));
+        }
+        body(size_t(0), grain);
+        wait(group);
+    }
+
+    // Sets workerCount and the task callbacks so Box2D runs its step on this pool
+    void attach(b2WorldDef& worldDef);
+};
+
+// Process-wide pool shared by physics, controllers and rendering. Configure it
+// before first use; returns false if it already exists.
+bool configureSharedThreadPool(const threadPoolConfig& config);
+threadPool& sharedThreadPool();
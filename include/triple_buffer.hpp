@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Single-producer / single-consumer triple buffer. The producer always has a
+// private buffer to fill and the consumer always has a private buffer to read;
+// publishing and consuming are a single atomic exchange of the shared middle slot.
+template <typename T>
+class tripleBuffer {
+private:
+    static constexpr uint8_t indexMask = 0x3;
+    static constexpr uint8_t freshBit = 0x4;
+
+    T buffers[3];
+    alignas(64) std::atomic<uint8_t> middle{1};
+    alignas(64) uint8_t back = 0;  // owned by the producer
+    alignas(64) uint8_t front = 2; // owned by the consumer
+public:
+    T& writeBuffer() { return buffers[back]; }
+
+    void publish() {
+        back = middle.exchange(back | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // Returns true if a newer buffer was published since the last call
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & freshBit)) {
+            return false;
+        }
+        front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    const T& readBuffer() const { return buffers[front]; }
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <box2d/box2d.h>
+
+struct windConfig {
+    // Grid nodes sit at origin + (i, j) * cellSize; samples outside clamp to the edge
+    b2Vec2 origin = { 0.0f, 0.0f };
+    float cellSize = 50.0f;
+    int columns = 17;
+    int rows = 13;
+
+    b2Vec2 mean = { 0.0f, 0.0f };
+    // Turbulence: std dev of each component, spatially smoothed over a few cells and
+    // periodic in time over frames * frameInterval seconds, so the loop is seamless
+    float turbulence = 0.0f;
+    int smoothing = 2; // box-blur passes; each widens the correlation length by about one cell
+    int frames = 64;
+    float frameInterval = 0.25f;
+
+    // 1-cosine gusts along the mean wind (+x when calm), at random onsets
+    float gustSpeed = 0.0f;
+    float gustInterval = 6.0f; // mean seconds between onsets
+    float gustDuration = 1.5f;
+
+    // Rotor thrust gain near the ground, Cheeseman-Bennett; rotorRadius 0 disables it
+    float groundLevel = 0.0f;
+    float rotorRadius = 0.0f;
+
+    uint64_t seed = 1;
+};
+
+// Drag model of one airframe. The wind is sampled at both ends of the span, so
+// shear across the airframe turns into a torque.
+struct airframeDrag {
+    float halfSpan = 0.0f;
+    float frontalArea = 0.0f;  // facing flow along the body x axis
+    float planformArea = 0.0f; // facing flow along the body y axis
+    float dragCoefficient = 1.0f;
+    float airDensity = 1.0f;
+};
+
+// Structure-of-arrays view of the drones to load; thrust is each drone's total
+// rotor thrust along its body y axis, for ground effect, and may be null
+struct windBodies {
+    size_t count = 0;
+    const float* posX = nullptr;
+    const float* posY = nullptr;
+    const float* rotC = nullptr;
+    const float* rotS = nullptr;
+    const float* velX = nullptr;
+    const float* velY = nullptr;
+    const float* thrust = nullptr;
+};
+
+// Force at the center of mass and torque, per drone
+struct windLoads {
+    float* forceX = nullptr;
+    float* forceY = nullptr;
+    float* torque = nullptr;
+};
+
+// Wind precomputed on a regular grid: turbulence frames are built once, and
+// advance() blends the two frames around the current time plus the active gusts
+// into one grid, so per-drone sampling is a clamped bilinear lookup with no
+// branches. Sampling is const and may run from several threads; advance() may not.
+class windField {
+private:
+    windConfig config;
+    size_t cellCount;
+    std::vector<float> frameU, frameV;     // frames * cellCount
+    std::vector<float> currentU, currentV; // cellCount, at the last advance()
+    std::vector<float> gustOnsets;         // seconds into the loop
+    float period;
+    float time;
+    b2Vec2 gustDirection;
+
+    void buildTurbulence();
+    b2Vec2 gustAt(float time) const;
+public:
+    windField(const windConfig& config = windConfig()); // constructor
+
+    // Moves the field to an absolute simulated time; cost is one pass over the grid
+    void advance(float time);
+    float getTime() const { return time; }
+
+    b2Vec2 sample(float x, float y) const;
+    void sample(const float* x, const float* y, size_t count, float* u, float* v) const;
+    // Thrust multiplier for a rotor `height` above the ground, 1 when out of ground effect
+    float groundEffect(float height) const;
+
+    const windConfig& getConfig() const { return config; }
+};
+
+// Cheeseman-Bennett thrust multiplier for a rotor of `radius` at `height` above
+// the ground; 1 when radius is 0
+float groundEffectGain(float radius, float height);
+
+// Quadratic drag from the air velocity relative to each drone, evaluated at both
+// span ends, plus the ground-effect share of its thrust
+void computeWindLoads(const windField& field, const airframeDrag& airframe, const windBodies& bodies, const windLoads& out);
+
+// Grid over an area with roughly `cellSize` cells, other settings from `base`
+windConfig windConfigOver(const windConfig& base, b2Vec2 lower, b2Vec2 upper, float cellSize);
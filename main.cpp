@@ -10,184 +10,1160 @@
 #include <atomic>
 #include <optional>
 #include <string>
+#include <span>
+#include <cstdlib>
+#include <cstdio>
 
 #include "include/draw.hpp"
 #include "include/body.hpp"
 #include "include/drone.hpp"
+#include "include/entity_registry.hpp"
+#include "include/simulation.hpp"
+#include "include/swarm.hpp"
+#include "include/physics_loop.hpp"
+#include "include/frame_scheduler.hpp"
+#include "include/thread_pool.hpp"
+#include "include/snapshot.hpp"
+#include "include/flight_recorder.hpp"
+#include "include/branching.hpp"
+#include "include/drone_dynamics.hpp"
+#include "include/dynamics_validation.hpp"
 #include "include/controller/pid.hpp"
+#include "include/controller/tuner.hpp"
 #include "include/force_arrows.hpp"
+#include "include/frame_capture.hpp"
+#include "include/telemetry.hpp"
+#include "include/sprite_atlas.hpp"
+#include "include/profiler.hpp"
+#include "include/profiler_overlay.hpp"
 
 volatile std::sig_atomic_t g_stop = 0;
 extern "C" void sigint_handler(int) {
     g_stop = 1; // only set a sig_atomic_t
 }
 
-int main() {
+struct options {
+    bool headless = false;
+    long long steps = 10000;
+    int swarmSize = 0;
+    bool fastDynamics = false;
+    bool validateDynamics = false;
+    bool tune = false;
+    int tuneGrid = 12;
+    float physicsRate = 240.0f;
+    float frameRate = 60.0f;
+    int spinMicros = 100;
+    std::string recordPath;
+    unsigned long long recordCapacity = 1ull << 18;
+    std::string replayPath;
+    std::string exportInput;
+    std::string csvOutput;
+    std::string columnsOutput;
+    bool verifyDeterminism = false;
+    int forks = 0;
+    controllerKind controller = controllerKind::hover;
+    std::string tracePath;
+    bool useEstimator = false;
+    unsigned int threads = 0;
+    bool pinThreads = false;
+    bool parallelPhysics = false;
+    int motors = 2;
+    std::string capturePath;
+    unsigned int captureWidth = 1280;
+    unsigned int captureHeight = 720;
+    unsigned int captureFps = 60;
+    int telemetryPort = -1; // -1 = off, 0 = any free port
+    std::string telemetryPeer;
+    double telemetryTestSeconds = 0.0;
+    float windSpeed = 0.0f;
+    float turbulence = 0.0f;
+    float gustSpeed = 0.0f;
+    bool groundEffect = false;
+};
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --rate HZ                  physics rate of the windowed simulation\n"
+              << "  --fps HZ                   render frame limit (0 for unlimited)\n"
+              << "  --spin-us N                busy-wait before each physics step and frame (0 = sleep only)\n"
+              << "  --headless --steps N       step without a window as fast as possible\n"
+              << "  --swarm N [--fast]         headless swarm of N drones (--fast: analytic integrator, no Box2D)\n"
+              << "  --validate-dynamics        compare the analytic integrator with Box2D under identical thrust\n"
+              << "  --tune [--tune-grid N]     parallel PID gain sweep\n"
+              << "  --record FILE              record every physics step to FILE\n"
+              << "  --record-capacity N        ring buffer size in steps\n"
+              << "  --replay FILE              scrub through a recording in the window\n"
+              << "  --export FILE [--csv OUT] [--columns OUT]  convert a recording\n"
+              << "  --verify-determinism       check checkpoint restores reproduce a run bit for bit\n"
+              << "  --fork N                   fork N what-if continuations from one checkpoint\n"
+              << "  --controller hover|cascade|mppi  altitude-only PID, cascaded altitude+attitude, or sampling MPC\n"
+              << "  --motors N                 rotors per airframe: 2, 4, 6 or 8\n"
+              << "  --estimator                control from simulated IMU + barometer through the state estimator\n"
+              << "  --threads N                size of the shared worker pool (0 = all cores)\n"
+              << "  --pin                      pin pool threads to cores\n"
+              << "  --parallel-physics         step the single-drone world on the pool too\n"
+              << "  --capture PATH [--capture-size WxH] [--capture-fps N]  render --steps offscreen to\n"
+              << "                             PATH.y4m, or a PNG sequence PATH_000000.png, ...\n"
+              << "  --wind SPEED [--turbulence SIGMA] [--gusts SPEED]  steady wind along +x, turbulence and\n"
+              << "                             1-cosine gusts\n"
+              << "  --ground-effect            rotor thrust gain near the ground\n"
+              << "  --telemetry PORT [--telemetry-peer HOST:PORT]  stream state over UDP and accept setpoint\n"
+              << "                             and gain commands on PORT (default peer: the first command sender)\n"
+              << "  --telemetry-test SECONDS   drive the physics loop from a loopback client, report latency and loss\n"
+              << "  --trace FILE               write a Chrome trace of the profiling zones on exit" << std::endl;
+}
+
+static bool parseOptions(int argc, char** argv, options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            opts.headless = true;
+        } else if (arg == "--steps" && i + 1 < argc) {
+            opts.steps = std::atoll(argv[++i]);
+        } else if (arg == "--swarm" && i + 1 < argc) {
+            opts.swarmSize = std::atoi(argv[++i]);
+        } else if (arg == "--fast") {
+            opts.fastDynamics = true;
+        } else if (arg == "--validate-dynamics") {
+            opts.validateDynamics = true;
+        } else if (arg == "--tune") {
+            opts.tune = true;
+        } else if (arg == "--tune-grid" && i + 1 < argc) {
+            opts.tuneGrid = std::atoi(argv[++i]);
+        } else if (arg == "--rate" && i + 1 < argc) {
+            opts.physicsRate = static_cast<float>(std::atof(argv[++i]));
+            if (!(opts.physicsRate > 0.0f)) {
+                std::cerr << "--rate expects a positive rate in Hz" << std::endl;
+                return false;
+            }
+        } else if (arg == "--fps" && i + 1 < argc) {
+            opts.frameRate = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--spin-us" && i + 1 < argc) {
+            opts.spinMicros = std::max(std::atoi(argv[++i]), 0);
+        } else if (arg == "--record" && i + 1 < argc) {
+            opts.recordPath = argv[++i];
+        } else if (arg == "--record-capacity" && i + 1 < argc) {
+            opts.recordCapacity = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--replay" && i + 1 < argc) {
+            opts.replayPath = argv[++i];
+        } else if (arg == "--export" && i + 1 < argc) {
+            opts.exportInput = argv[++i];
+        } else if (arg == "--csv" && i + 1 < argc) {
+            opts.csvOutput = argv[++i];
+        } else if (arg == "--columns" && i + 1 < argc) {
+            opts.columnsOutput = argv[++i];
+        } else if (arg == "--verify-determinism") {
+            opts.verifyDeterminism = true;
+        } else if (arg == "--fork" && i + 1 < argc) {
+            opts.forks = std::atoi(argv[++i]);
+        } else if (arg == "--controller" && i + 1 < argc) {
+            std::string kind = argv[++i];
+            if (kind == "cascade") {
+                opts.controller = controllerKind::cascade;
+            } else if (kind == "hover") {
+                opts.controller = controllerKind::hover;
+            } else if (kind == "mppi") {
+                opts.controller = controllerKind::mppi;
+            } else {
+                printUsage(argv[0]);
+                return false;
+            }
+        } else if (arg == "--threads" && i + 1 < argc) {
+            opts.threads = static_cast<unsigned int>(std::atoi(argv[++i]));
+        } else if (arg == "--motors" && i + 1 < argc) {
+            opts.motors = std::atoi(argv[++i]);
+            if (opts.motors < 1 || opts.motors > control::maxMixerMotors) {
+                std::cerr << "--motors must be between 1 and " << control::maxMixerMotors << std::endl;
+                return false;
+            }
+        } else if (arg == "--capture" && i + 1 < argc) {
+            opts.capturePath = argv[++i];
+        } else if (arg == "--capture-size" && i + 1 < argc) {
+            unsigned int width = 0;
+            unsigned int height = 0;
+            if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+                std::cerr << "--capture-size expects WIDTHxHEIGHT" << std::endl;
+                return false;
+            }
+            opts.captureWidth = width;
+            opts.captureHeight = height;
+        } else if (arg == "--capture-fps" && i + 1 < argc) {
+            opts.captureFps = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--telemetry" && i + 1 < argc) {
+            opts.telemetryPort = std::atoi(argv[++i]);
+            if (opts.telemetryPort < 0 || opts.telemetryPort > 65535) {
+                std::cerr << "--telemetry expects a port number" << std::endl;
+                return false;
+            }
+        } else if (arg == "--telemetry-peer" && i + 1 < argc) {
+            opts.telemetryPeer = argv[++i];
+        } else if (arg == "--telemetry-test" && i + 1 < argc) {
+            opts.telemetryTestSeconds = std::atof(argv[++i]);
+        } else if (arg == "--wind" && i + 1 < argc) {
+            opts.windSpeed = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--turbulence" && i + 1 < argc) {
+            opts.turbulence = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--gusts" && i + 1 < argc) {
+            opts.gustSpeed = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--ground-effect") {
+            opts.groundEffect = true;
+        } else if (arg == "--pin") {
+            opts.pinThreads = true;
+        } else if (arg == "--parallel-physics") {
+            opts.parallelPhysics = true;
+        } else if (arg == "--estimator") {
+            opts.useEstimator = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            opts.tracePath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void printSchedulerStats(const char* label, const schedulerStats& stats) {
+    std::cout << label << ": " << stats.ticks << " ticks, " << stats.deadlineMisses << " deadline misses"
+              << ", max lateness " << stats.maxLatenessSeconds * 1000.0 << "ms";
+    if (stats.steps > 0) {
+        std::cout << ", " << stats.steps << " steps, " << stats.catchUpTicks << " catch-up ticks, "
+                  << stats.droppedSteps << " dropped steps, step debt mean " << stats.meanStepDebt()
+                  << " max " << stats.maxStepDebt;
+    }
+    std::cout << std::endl;
+}
+
+static void writeTrace(const std::string& path) {
+    if (profiling::writeChromeTrace(path)) {
+        std::cout << "Wrote trace to " << path << std::endl;
+    } else {
+        std::cerr << "Failed to write trace: " << path << std::endl;
+    }
+}
+
+static bool windEnabled(const options& opts) {
+    return opts.windSpeed != 0.0f || opts.turbulence > 0.0f || opts.gustSpeed > 0.0f;
+}
+
+static void configureAir(const options& opts, simulationConfig& config) {
+    config.enableWind = windEnabled(opts);
+    config.wind.mean = { opts.windSpeed, 0.0f };
+    config.wind.turbulence = opts.turbulence;
+    config.wind.gustSpeed = opts.gustSpeed;
+    config.groundEffect = opts.groundEffect;
+}
+
+static bool openRecorder(const options& opts, flightRecorder& recorder, float timeStep) {
+    if (opts.recordPath.empty()) {
+        return true;
+    }
+    if (!recorder.open(opts.recordPath, opts.recordCapacity, timeStep)) {
+        std::cerr << "Failed to create recording: " << opts.recordPath << std::endl;
+        return false;
+    }
+    std::cout << "Recording to " << opts.recordPath << " (" << opts.recordCapacity << " step ring buffer)" << std::endl;
+    return true;
+}
+
+static bool openTelemetry(const options& opts, telemetryServer& server, physicsLoop* loop) {
+    if (opts.telemetryPort < 0) {
+        return true;
+    }
+    telemetryConfig link;
+    link.port = static_cast<unsigned short>(opts.telemetryPort);
+    if (!opts.telemetryPeer.empty()) {
+        size_t colon = opts.telemetryPeer.rfind(':');
+        std::string host = opts.telemetryPeer.substr(0, colon);
+        std::optional<sf::IpAddress> address = sf::IpAddress::resolve(host.c_str());
+        int port = colon == std::string::npos ? 0 : std::atoi(opts.telemetryPeer.c_str() + colon + 1);
+        if (!address || port <= 0 || port > 65535) {
+            std::cerr << "--telemetry-peer expects HOST:PORT" << std::endl;
+            return false;
+        }
+        link.peer = address;
+        link.peerPort = static_cast<unsigned short>(port);
+    }
+    if (!server.open(link, loop)) {
+        return false;
+    }
+    std::cout << "Telemetry on UDP port " << server.getPort() << std::endl;
+    return true;
+}
+
+static void printTelemetryStats(const telemetryServerStats& stats) {
+    std::cout << "Telemetry: " << stats.records << " records in " << stats.datagrams << " datagrams, "
+              << stats.sendFailures << " send failures, " << stats.commands << " commands, "
+              << stats.rejected << " rejected" << std::endl;
+}
+
+// Step the world as fast as the CPU allows and report throughput
+static int runHeadless(const options& opts) {
+    simulationConfig config;
+    config.controller = opts.controller;
+    config.useEstimator = opts.useEstimator;
+    config.motorCount = opts.motors;
+    config.multithreadedPhysics = opts.parallelPhysics;
+    configureAir(opts, config);
+    simulation sim(config);
+    flightRecorder recorder;
+    if (!openRecorder(opts, recorder, sim.getConfig().timeStep)) {
+        return 1;
+    }
+    telemetryServer telemetryLink;
+    if (!openTelemetry(opts, telemetryLink, nullptr)) {
+        return 1;
+    }
+    std::cout << "Headless run: " << opts.steps << " steps of " << sim.getConfig().timeStep << "s with the "
+              << controllerName(sim.getControllerKind()) << " controller" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    long long step = 0;
+    double squaredEstimateError = 0.0;
+    for (; step < opts.steps && !g_stop; ++step) {
+        sim.step();
+        if (recorder.isOpen()) {
+            recorder.record(step + 1, sim);
+        }
+        if (opts.telemetryPort >= 0) {
+            telemetryLink.afterStep(step + 1, sim);
+        }
+        if (opts.useEstimator) {
+            double error = sim.getEstimate().y - sim.getDrone().altitude();
+            squaredEstimateError += error * error;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double simulated = step * sim.getConfig().timeStep;
+    std::cout << "Steps: " << step << std::endl;
+    std::cout << "Wall time: " << seconds << "s" << std::endl;
+    std::cout << "Steps/second: " << (seconds > 0.0 ? step / seconds : 0.0) << std::endl;
+    std::cout << "Real-time factor: " << (seconds > 0.0 ? simulated / seconds : 0.0) << "x" << std::endl;
+    std::cout << "Final altitude: " << sim.getDrone().altitude() << " (target " << sim.getTargetAltitude() << ")" << std::endl;
+    if (opts.useEstimator && step > 0) {
+        std::cout << "Altitude estimate RMS error: " << std::sqrt(squaredEstimateError / step) << std::endl;
+    }
+    if (opts.telemetryPort >= 0) {
+        telemetryLink.flush();
+        printTelemetryStats(telemetryLink.getStats());
+    }
+    if (!opts.tracePath.empty()) {
+        writeTrace(opts.tracePath);
+    }
+    return 0;
+}
+
+// Hover a grid of drones in one world through the SoA swarm and report throughput
+static int runSwarm(const options& opts) {
+    simulationConfig config;
+    b2WorldDef worldDef = b2DefaultWorldDef();
+    worldDef.gravity = {0.0f, -9.81f};
+    sharedThreadPool().attach(worldDef);
+    b2WorldId worldId = b2CreateWorld(&worldDef);
+
+    float density = (50.0f * 50.0f) / (config.droneWidth * config.droneHeight);
+    std::vector<b2Vec2> motorLocal = control::evenMotorPositions(opts.motors, config.droneWidth * 0.45f, config.droneHeight * 0.3f);
+    std::vector<b2Vec2> motorDirections = control::verticalMotorDirections(opts.motors);
+
+    // Spaced so airframes never touch and the broadphase stays cheap
+    const int columns = 100;
+    const float spacingX = config.droneWidth * 1.5f;
+    const float spacingY = config.droneHeight * 3.0f;
+    entityRegistry entities(worldId, opts.swarmSize);
+    std::vector<float> targets;
+    targets.reserve(opts.swarmSize);
+    swarm fleet;
+    fleet.reserve(opts.swarmSize, motorLocal.size());
+    for (int i = 0; i < opts.swarmSize; ++i) {
+        b2Vec2 position = { (i % columns) * spacingX, 100.0f + (i / columns) * spacingY };
+        entityHandle airframe = entities.spawnBox(position, config.droneHeight, config.droneWidth, b2_dynamicBody, true, density);
+        fleet.addDrone(entities.getBody(airframe)->bodyId, motorLocal, motorDirections, config.maxThrustPerMotor);
+        targets.push_back(position.y + 10.0f);
+    }
+    // One field over the whole formation; this world has no ground, so no ground effect
+    std::optional<windField> wind;
+    if (windEnabled(opts)) {
+        configureAir(opts, config);
+        int rows = (opts.swarmSize + columns - 1) / columns;
+        wind.emplace(windConfigOver(config.wind, { -spacingX, 0.0f }, { columns * spacingX, 100.0f + (rows + 1) * spacingY }, 100.0f));
+        fleet.setWind(&*wind, airframeDragFor(config));
+    }
+    std::cout << "Swarm run: " << opts.swarmSize << " drones, " << fleet.motorCount() << " motors, " << opts.steps << " steps on "
+              << sharedThreadPool().concurrency() << " threads" << std::endl;
+
+    // Same attitude loop placement as the cascade controller: 4 rad/s, damping 0.8
+    float inertia = opts.swarmSize > 0 ? b2Body_GetMassData(fleet.getBody(0)).rotationalInertia : 0.0f;
+    float attitudeKp = inertia * 16.0f;
+    float attitudeKd = inertia * 6.4f;
+    std::vector<float> collective(opts.swarmSize);
+    std::vector<float> torque(opts.swarmSize);
+
+    auto start = std::chrono::steady_clock::now();
+    long long step = 0;
+    for (; step < opts.steps && !g_stop; ++step) {
+        fleet.syncState();
+        for (size_t i = 0; i < fleet.size(); ++i) {
+            float error = targets[i] - fleet.altitude(i);
+            collective[i] = fleet.gravitationalForce(i) + config.kp * error - config.kd * fleet.getLinearVelocity(i).y;
+            float angle = b2Rot_GetAngle(fleet.getRotation(i));
+            torque[i] = -attitudeKp * angle - attitudeKd * b2Body_GetAngularVelocity(fleet.getBody(i));
+        }
+        fleet.setWrenches(collective.data(), torque.data());
+        if (wind) {
+            wind->advance(step * config.timeStep);
+        }
+        fleet.applyCommands();
+        b2World_Step(worldId, config.timeStep, config.subStepCount);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "Steps: " << step << std::endl;
+    std::cout << "Wall time: " << seconds << "s" << std::endl;
+    std::cout << "Steps/second: " << (seconds > 0.0 ? step / seconds : 0.0) << std::endl;
+    std::cout << "Drone-steps/second: " << (seconds > 0.0 ? step * fleet.size() / seconds : 0.0) << std::endl;
+
+    b2DestroyWorld(worldId);
+    return 0;
+}
+
+// Same hover loop as runSwarm on the contact-free analytic integrator
+static int runFastSwarm(const options& opts) {
+    simulationConfig config;
+    config.motorCount = opts.motors;
+    simulation reference(config); // only to read the airframe's mass properties and motors
+    droneDynamics fleet(makeDroneModel(reference.getDrone()), config.subStepCount);
+    fleet.reserve(opts.swarmSize);
+    std::vector<float> targets;
+    targets.reserve(opts.swarmSize);
+    const int columns = 100;
+    for (int i = 0; i < opts.swarmSize; ++i) {
+        b2Vec2 position = { (i % columns) * config.droneWidth * 1.5f, 100.0f + (i / columns) * config.droneHeight * 3.0f };
+        fleet.addDrone({ position, b2MakeRot(0.0f), { 0.0f, 0.0f }, 0.0f });
+        targets.push_back(position.y + 10.0f);
+    }
+    std::optional<windField> wind;
+    if (windEnabled(opts)) {
+        configureAir(opts, config);
+        int rows = (opts.swarmSize + columns - 1) / columns;
+        wind.emplace(windConfigOver(config.wind, { -config.droneWidth * 1.5f, 0.0f },
+                                    { columns * config.droneWidth * 1.5f, 100.0f + (rows + 1) * config.droneHeight * 3.0f }, 100.0f));
+        fleet.setWind(&*wind, airframeDragFor(config));
+    }
+    std::cout << "Fast swarm run: " << opts.swarmSize << " drones, " << opts.steps << " steps" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    long long step = 0;
+    for (; step < opts.steps && !g_stop; ++step) {
+        for (size_t i = 0; i < fleet.size(); ++i) {
+            float error = targets[i] - fleet.altitude(i);
+            fleet.setThrustEvenly(i, fleet.weight() + config.kp * error - config.kd * fleet.verticalVelocity(i));
+        }
+        if (wind) {
+            wind->advance(step * config.timeStep);
+        }
+        fleet.step(config.timeStep);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "Steps: " << step << std::endl;
+    std::cout << "Wall time: " << seconds << "s" << std::endl;
+    std::cout << "Drone-steps/second: " << (seconds > 0.0 ? step * fleet.size() / seconds : 0.0) << std::endl;
+    return 0;
+}
+
+static int runDynamicsValidation() {
+    simulationConfig config;
+    dynamicsValidation report = validateDynamics(config);
+    std::cout << "Compared " << report.steps << " steps of the analytic integrator against Box2D" << std::endl;
+    std::cout << "Max position error: " << report.maxPositionError << " (final " << report.finalPositionError << ")" << std::endl;
+    std::cout << "Max velocity error: " << report.maxVelocityError << std::endl;
+    std::cout << "Max angle error: " << report.maxAngleError << " rad" << std::endl;
+    if (report.firstStepOverTolerance >= 0) {
+        std::cout << "Position error first exceeded tolerance at step " << report.firstStepOverTolerance << std::endl;
+    }
+    return 0;
+}
+
+// Sweep a log-spaced gain grid around the hand-tuned defaults and print the Pareto set
+static int runTuner(const options& opts) {
+    simulationConfig config;
+    pid::gainTuner tuner(config);
+    pid::gains low = { config.kp * 0.1f, config.ki * 0.1f, config.kd * 0.1f };
+    pid::gains high = { config.kp * 10.0f, config.ki * 10.0f, config.kd * 10.0f };
+    std::vector<pid::gains> candidates = pid::gainTuner::logGrid(low, high, opts.tuneGrid);
+    std::cout << "Tuning " << candidates.size() << " gain sets on " << tuner.getThreadCount() << " threads" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<pid::tuningResult> results = tuner.sweep(candidates);
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "Evaluated in " << seconds << "s (" << (seconds > 0.0 ? candidates.size() / seconds : 0.0) << " sets/s)" << std::endl;
+
+    std::vector<pid::tuningResult> front = pid::gainTuner::paretoFront(results);
+    std::cout << "Pareto-optimal gain sets: " << front.size() << std::endl;
+    std::cout << "kp,ki,kd,overshoot,settling_time,itae,saturation" << std::endl;
+    for (const auto& result : front) {
+        std::cout << result.candidate.kp << "," << result.candidate.ki << "," << result.candidate.kd << ","
+                  << result.response.overshoot << "," << result.response.settlingTime << ","
+                  << result.response.itae << "," << result.response.saturation << std::endl;
+    }
+    return 0;
+}
+
+static int runDeterminismCheck() {
+    simulationConfig config;
+    determinismReport report = verifyDeterminism(config);
+    std::cout << "Compared " << report.stepsCompared << " steps after the checkpoint" << std::endl;
+    std::cout << "Restore into fresh world: " << (report.freshWorldBitExact ? "bit-exact" : "DIVERGED") << std::endl;
+    std::cout << "Rewind in place: " << (report.rewindBitExact ? "bit-exact" : "DIVERGED") << std::endl;
+    if (report.firstDivergentStep >= 0) {
+        std::cout << "First divergent step: " << report.firstDivergentStep
+                  << ", max position error: " << report.maxPositionError << std::endl;
+    }
+    return report.freshWorldBitExact && report.rewindBitExact ? 0 : 1;
+}
+
+// Fly up to a checkpoint, then branch one continuation per target altitude
+static int runForks(const options& opts) {
+    simulationConfig config;
+    simulation sim(config);
+    sim.setTargetAltitude(sim.getTargetAltitude() + 50.0f);
+    for (int i = 0; i < 300; ++i) {
+        sim.step();
+    }
+    checkpoint from;
+    sim.saveCheckpoint(from);
+
+    std::vector<float> targets(opts.forks);
+    for (int i = 0; i < opts.forks; ++i) {
+        float f = opts.forks > 1 ? static_cast<float>(i) / (opts.forks - 1) : 0.5f;
+        targets[i] = std::max(from.targetAltitude - 100.0f + 200.0f * f, 0.0f);
+    }
+    const int steps = 300;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<bodyState> results = forkContinuations(config, from, targets, steps);
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    float maxError = 0.0f;
+    for (size_t i = 0; i < results.size(); ++i) {
+        maxError = std::max(maxError, std::abs(results[i].transform.p.y - targets[i]));
+    }
+    std::cout << "Forked " << results.size() << " continuations of " << steps << " steps from step " << from.step
+              << " in " << seconds << "s (" << (seconds > 0.0 ? results.size() / seconds : 0.0) << " forks/s)" << std::endl;
+    std::cout << "Largest final altitude error across forks: " << maxError << std::endl;
+    return 0;
+}
+
+static int runExport(const options& opts) {
+    flightLog log;
+    if (!log.open(opts.exportInput)) {
+        std::cerr << "Failed to open recording: " << opts.exportInput << std::endl;
+        return 1;
+    }
+    std::cout << "Recording holds " << log.size() << " steps" << std::endl;
+    if (!opts.csvOutput.empty()) {
+        if (!log.exportCsv(opts.csvOutput)) {
+            std::cerr << "Failed to write " << opts.csvOutput << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote " << opts.csvOutput << std::endl;
+    }
+    if (!opts.columnsOutput.empty()) {
+        if (!log.exportColumns(opts.columnsOutput)) {
+            std::cerr << "Failed to write " << opts.columnsOutput << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote " << opts.columnsOutput << std::endl;
+    }
+    return 0;
+}
+
+// The skins are compiled into the binary, so this works from any working directory
+static bool loadDroneAtlas(spriteAtlas& atlas) {
+    return addDroneSkins(atlas) > 0 && atlas.build();
+}
+
+// Play back a recording in the window. Space pauses, Left/Right step one record
+// (ten with Shift) while paused, Home/End jump to the ends.
+static int runReplay(const options& opts) {
+    flightLog log;
+    if (!log.open(opts.replayPath)) {
+        std::cerr << "Failed to open recording: " << opts.replayPath << std::endl;
+        return 1;
+    }
+    if (log.size() == 0) {
+        std::cerr << "Recording is empty: " << opts.replayPath << std::endl;
+        return 1;
+    }
+    std::cout << "Replaying " << log.size() << " steps from " << opts.replayPath << std::endl;
+
+    unsigned int windowWidth = 800;
+    unsigned int windowHeight = 600;
+    draw drawer(windowWidth, windowHeight);
+
+    spriteAtlas droneAtlas;
+    if (!loadDroneAtlas(droneAtlas)) {
+        return 1;
+    }
+    spriteBatch droneSprites(droneAtlas);
+    const size_t droneSkin = droneAtlas.find("drone");
+    sf::Vector2u texSize = sf::Vector2u(droneAtlas.getRegion(droneSkin).size);
+    float droneScale = 0.15f;
+
+    // The scene is only built for its static geometry and airframe; it is never stepped
+    simulationConfig config;
+    config.worldWidth = static_cast<float>(windowWidth);
+    config.worldHeight = static_cast<float>(windowHeight);
+    config.droneWidth = texSize.x * droneScale;
+    config.droneHeight = texSize.y * droneScale;
+    simulation sim(config);
+    drawer.addShape(sim.getEntities(), sim.getGroundEntity());
+    drawer.addShape(sim.getEntities(), sim.getTargetEntity());
+
+    worldSnapshot view;
+    captureBodies(sim.getEntities(), drawer.getShapes(), view.bodyTransforms);
+    captureDrone(sim.getDrone(), view.droneState);
+    ForceArrowDrawer forceDrawer(0.3f, 12.0f);
+
+    size_t index = 0;
+    bool playing = true;
+    double playbackTime = log.at(0).time;
+    auto lastFrame = std::chrono::steady_clock::now();
+    frameLimiter limiter(opts.frameRate, std::chrono::microseconds(opts.spinMicros));
+
+    while (drawer.isOpen() && !g_stop) {
+        while (std::optional<sf::Event> event = drawer.pollEvent()) {
+            if (event->is<sf::Event::Closed>()) {
+                drawer.close();
+                break;
+            }
+            if (const auto keyPressed = event->getIf<sf::Event::KeyPressed>()) {
+                size_t stride = keyPressed->shift ? 10 : 1;
+                if (keyPressed->scancode == sf::Keyboard::Scancode::Space) {
+                    playing = !playing;
+                }
+                if (keyPressed->scancode == sf::Keyboard::Scancode::Right) {
+                    index = std::min(index + stride, log.size() - 1);
+                    playing = false;
+                }
+                if (keyPressed->scancode == sf::Keyboard::Scancode::Left) {
+                    index = index > stride ? index - stride : 0;
+                    playing = false;
+                }
+                if (keyPressed->scancode == sf::Keyboard::Scancode::Home) {
+                    index = 0;
+                }
+                if (keyPressed->scancode == sf::Keyboard::Scancode::End) {
+                    index = log.size() - 1;
+                }
+                playbackTime = log.at(index).time;
+            }
+        }
+        if (!drawer.isOpen()) {
+            break;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (playing) {
+            playbackTime += std::chrono::duration<double>(now - lastFrame).count();
+            while (index + 1 < log.size() && log.at(index + 1).time <= playbackTime) {
+                ++index;
+            }
+        }
+        lastFrame = now;
+
+        const flightRecord& r = log.at(index);
+        view.droneState.transform = { { r.posX, r.posY }, b2MakeRot(r.angle) };
+        view.droneState.linearVelocity = { r.velX, r.velY };
+        view.droneState.angularVelocity = r.angularVelocity;
+        view.droneState.thrust.assign(r.thrust, r.thrust + r.motorCount);
+        view.bodyTransforms[1] = { { config.worldWidth / 2.0f, r.targetAltitude }, b2MakeRot(0.0f) };
+
+        drawer.clear();
+        drawer.drawShapes(view.bodyTransforms);
+        droneSprites.add(droneSkin, drawer.toWindowLocation(r.posX, r.posY), sf::degrees(-r.angle * 180.0f / 3.14159f), droneScale);
+        droneSprites.flush(drawer.getTarget());
+        forceDrawer.addNetForce(view.droneState, drawer.getViewTransform(), sf::Color::Magenta, sf::Color::Cyan, sf::Color::Yellow);
+        forceDrawer.flush(drawer.getTarget());
+        drawer.display();
+        limiter.wait();
+    }
+    return 0;
+}
+
+// Step the simulation without a window and render every frame of a fixed-rate
+// video offscreen. The target altitude alternates every three seconds so the
+// clip shows the controller working.
+static int runCapture(const options& opts) {
+    spriteAtlas droneAtlas;
+    if (!loadDroneAtlas(droneAtlas)) {
+        return 1;
+    }
+    spriteBatch droneSprites(droneAtlas);
+    const size_t droneSkin = droneAtlas.find("drone");
+    sf::Vector2u texSize = sf::Vector2u(droneAtlas.getRegion(droneSkin).size);
+    float droneScale = 0.15f;
+
+    simulationConfig config;
+    config.worldWidth = static_cast<float>(opts.captureWidth);
+    config.worldHeight = static_cast<float>(opts.captureHeight);
+    config.droneWidth = texSize.x * droneScale;
+    config.droneHeight = texSize.y * droneScale;
+    config.timeStep = 1.0f / opts.physicsRate;
+    config.controller = opts.controller;
+    config.useEstimator = opts.useEstimator;
+    config.motorCount = opts.motors;
+    config.multithreadedPhysics = opts.parallelPhysics;
+    configureAir(opts, config);
+    simulation sim(config);
+    const float lowTarget = sim.getTargetAltitude() + 100.0f;
+    const float highTarget = std::min(lowTarget + 200.0f, config.worldHeight - config.droneHeight);
+
+    draw drawer(opts.captureWidth, opts.captureHeight, true);
+    drawer.addShape(sim.getEntities(), sim.getGroundEntity());
+    drawer.addShape(sim.getEntities(), sim.getTargetEntity());
+    ForceArrowDrawer forceDrawer(0.3f, 12.0f);
+    droneSnapshot droneState;
+
+    captureConfig settings;
+    settings.path = opts.capturePath;
+    settings.format = captureFormatFor(opts.capturePath);
+    settings.width = opts.captureWidth;
+    settings.height = opts.captureHeight;
+    settings.fps = opts.captureFps;
+    frameCapture capture;
+    if (!capture.open(settings)) {
+        return 1;
+    }
+    sf::RenderTexture& target = *drawer.getOffscreenTarget();
+    std::cout << "Capturing " << opts.steps << " steps at " << opts.captureWidth << "x" << opts.captureHeight << ", "
+              << opts.captureFps << " fps to " << opts.capturePath << std::endl;
+
+    // Frames are spaced in simulated time, independent of the physics rate
+    const double frameInterval = 1.0 / opts.captureFps;
+    long long frame = 0;
+    auto start = std::chrono::steady_clock::now();
+    long long step = 0;
+    for (; step < opts.steps && !g_stop; ++step) {
+        double time = step * static_cast<double>(config.timeStep);
+        float altitude = static_cast<int>(time / 3.0) % 2 == 0 ? lowTarget : highTarget;
+        if (altitude != sim.getTargetAltitude()) {
+            sim.setTargetAltitude(altitude);
+        }
+        sim.step();
+        const double stepEnd = time + config.timeStep;
+        if (stepEnd < frame * frameInterval) {
+            continue;
+        }
+
+        drawer.clear();
+        drawer.drawShapes();
+        captureDrone(sim.getDrone(), droneState);
+        b2Vec2 dronePos = droneState.transform.p;
+        droneSprites.add(droneSkin, drawer.toWindowLocation(dronePos.x, dronePos.y),
+                         sf::degrees(-b2Rot_GetAngle(droneState.transform.q) * 180.0f / 3.14159f), droneScale);
+        droneSprites.flush(target);
+        forceDrawer.addMotorThrusts(std::span<const droneSnapshot>(&droneState, 1), drawer.getViewTransform());
+        forceDrawer.flush(target);
+        drawer.display();
+        // Above the physics rate one step spans several frame slots; repeating the
+        // frame keeps the clip at the frame rate its header declares
+        for (; frame * frameInterval <= stepEnd; ++frame) {
+            capture.capture(target);
+        }
+    }
+    auto renderEnd = std::chrono::steady_clock::now();
+    capture.close(target);
+    auto end = std::chrono::steady_clock::now();
+
+    captureStats stats = capture.getStats();
+    double renderSeconds = std::chrono::duration<double>(renderEnd - start).count();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double simulated = step * static_cast<double>(config.timeStep);
+    std::cout << "Frames: " << stats.written << " written, " << stats.dropped << " dropped ("
+              << (stats.asyncReadback ? "pixel-buffer" : "synchronous") << " readback)" << std::endl;
+    std::cout << "Render loop: " << renderSeconds << "s, " << stats.bufferWaits << " waits for a free buffer" << std::endl;
+    std::cout << "Encoder busy: " << stats.encodeSeconds << "s" << std::endl;
+    std::cout << "Wall time: " << seconds << "s, " << (seconds > 0.0 ? simulated / seconds : 0.0) << "x real time" << std::endl;
+    return stats.written == stats.submitted ? 0 : 1;
+}
+
+static double percentileMs(std::vector<double> samples, double p) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    size_t index = std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index] * 1000.0;
+}
+
+// Runs the real-time physics loop with a telemetry server and drives it from a
+// client over the loopback interface: a setpoint step every half second and one
+// gain update, while measuring what arrives back
+static int runTelemetryTest(const options& opts) {
+    simulationConfig config;
+    config.timeStep = 1.0f / opts.physicsRate;
+    config.controller = opts.controller;
+    config.useEstimator = opts.useEstimator;
+    config.motorCount = opts.motors;
+    configureAir(opts, config);
+    simulation sim(config);
+    const float baseTarget = sim.getTargetAltitude();
+    physicsLoop physics(sim, opts.physicsRate, 4, std::chrono::microseconds(opts.spinMicros));
+
+    options serverOpts = opts;
+    serverOpts.telemetryPort = std::max(opts.telemetryPort, 0);
+    serverOpts.telemetryPeer.clear();
+    telemetryServer server;
+    if (!openTelemetry(serverOpts, server, &physics)) {
+        return 1;
+    }
+    physics.setObserver(&server);
+    telemetryClient client;
+    if (!client.open(sf::IpAddress::LocalHost, server.getPort())) {
+        return 1;
+    }
+    std::cout << "Loopback telemetry test: " << opts.telemetryTestSeconds << "s at " << opts.physicsRate << " Hz" << std::endl;
+
+    physics.start();
+    client.send({ telemetry::commandType::hello });
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(opts.telemetryTestSeconds));
+    // The last command goes out early enough for the physics thread to pick it up before the end
+    auto lastCommand = end - std::chrono::milliseconds(100);
+    auto nextCommand = start;
+    const auto commandInterval = std::chrono::milliseconds(500);
+    int commandsSent = 0;
+    float lastSetpoint = baseTarget;
+    for (auto now = start; now < end && !g_stop; now = std::chrono::steady_clock::now()) {
+        if (now >= nextCommand && now < lastCommand) {
+            lastSetpoint = baseTarget + (commandsSent % 2 == 0 ? 150.0f : 50.0f);
+            std::vector<telemetry::commandRecord> commands = { { telemetry::commandType::setpoint, lastSetpoint } };
+            if (commandsSent == 0) {
+                commands.push_back({ telemetry::commandType::gains, config.kp, config.ki, config.kd });
+            }
+            client.send(commands);
+            ++commandsSent;
+            nextCommand += commandInterval;
+        }
+        client.poll();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    physics.stop();
+    server.flush();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    client.poll();
+
+    const telemetryServerStats& sent = server.getStats();
+    const telemetryClientStats& link = client.getStats();
+    uint64_t expected = link.datagrams + link.lost;
+    printTelemetryStats(sent);
+    std::cout << "Client: " << link.records << " records in " << link.datagrams << " datagrams, " << link.lost << " lost ("
+              << (expected > 0 ? 100.0 * link.lost / expected : 0.0) << "%), " << link.reordered << " reordered, "
+              << link.duplicates << " duplicates" << std::endl;
+    std::cout << "Latency: p50 " << percentileMs(link.latencySeconds, 0.50) << "ms, p99 " << percentileMs(link.latencySeconds, 0.99)
+              << "ms, max " << percentileMs(link.latencySeconds, 1.0) << "ms" << std::endl;
+    std::cout << "Command round trip: p50 " << percentileMs(link.roundTripSeconds, 0.50) << "ms, p99 "
+              << percentileMs(link.roundTripSeconds, 0.99) << "ms over " << link.roundTripSeconds.size() << " commands" << std::endl;
+    bool applied = physics.getTargetAltitude() == lastSetpoint;
+    std::cout << "Last setpoint " << (applied ? "applied" : "NOT applied") << " (" << lastSetpoint << ")" << std::endl;
+    printSchedulerStats("Physics", physics.getSchedulerStats());
+    return link.records > 0 && applied ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
     std::signal(SIGINT, sigint_handler);
     std::signal(SIGTERM, sigint_handler);
 
+    options opts;
+    if (!parseOptions(argc, argv, opts)) {
+        return 1;
+    }
+    threadPoolConfig poolConfig;
+    poolConfig.threads = opts.threads;
+    poolConfig.pinThreads = opts.pinThreads;
+    configureSharedThreadPool(poolConfig);
+    if (opts.pinThreads && !sharedThreadPool().isPinned()) {
+        std::cerr << "Thread pinning is not supported here; pool threads float" << std::endl;
+    }
+    if (opts.verifyDeterminism) {
+        return runDeterminismCheck();
+    }
+    if (opts.forks > 0) {
+        return runForks(opts);
+    }
+    if (!opts.exportInput.empty()) {
+        return runExport(opts);
+    }
+    if (!opts.replayPath.empty()) {
+        return runReplay(opts);
+    }
+    if (opts.tune) {
+        return runTuner(opts);
+    }
+    if (opts.validateDynamics) {
+        return runDynamicsValidation();
+    }
+    if (opts.swarmSize > 0) {
+        return opts.fastDynamics ? runFastSwarm(opts) : runSwarm(opts);
+    }
+    if (!opts.capturePath.empty()) {
+        return runCapture(opts);
+    }
+    if (opts.telemetryTestSeconds > 0.0) {
+        return runTelemetryTest(opts);
+    }
+    if (opts.headless) {
+        return runHeadless(opts);
+    }
+
     unsigned int windowWidth = 800;
     unsigned int windowHeight = 600;
 
-    float halfHeight = windowHeight / 2.0f;
-    float halfWidth = windowWidth / 2.0f;
-
     // Create Drawer
     draw drawer(windowWidth, windowHeight);
     drawer.clear();
     std::cout << "Window created: " << windowWidth << "x" << windowHeight << std::endl;
 
-    // Create World
-    b2WorldDef worldDef = b2DefaultWorldDef();
-    worldDef.gravity = {0.0f, -9.81f};
-    b2WorldId worldId = b2CreateWorld(&worldDef);
-    std::cout << "Box2D World created with gravity: " << worldDef.gravity.x << ", " << worldDef.gravity.y << std::endl;
-
-    // Load drone texture
-    sf::Texture droneTexture;
-    std::string texturePath = "../../src/assets/drone.png";
-    if (!droneTexture.loadFromFile(texturePath)) {
-        // Try alternative path if running from project root
-        texturePath = "src/assets/drone.png";
-        if (!droneTexture.loadFromFile(texturePath)) {
-            std::cerr << "Failed to load drone texture!" << std::endl;
-            return 1;
-        }
+    // Drone skins, packed into one atlas texture; K cycles through them
+    spriteAtlas droneAtlas;
+    if (!loadDroneAtlas(droneAtlas)) {
+        return 1;
     }
-    std::cout << "Loaded drone texture from: " << texturePath << std::endl;
-    sf::Sprite droneSprite(droneTexture);
+    spriteBatch droneSprites(droneAtlas);
+    size_t droneSkin = droneAtlas.find("drone");
     
     // Get texture size and calculate physics body dimensions
-    sf::Vector2u texSize = droneTexture.getSize();
+    sf::Vector2u texSize = sf::Vector2u(droneAtlas.getRegion(droneSkin).size);
     float droneScale = 0.15f; // Scale factor for the sprite
-    float droneWidth = texSize.x * droneScale;
-    float droneHeight = texSize.y * droneScale;
-    
-    // Set sprite origin to center
-    droneSprite.setOrigin(sf::Vector2f(texSize.x / 2.0f, texSize.y / 2.0f));
-    droneSprite.setScale(sf::Vector2f(droneScale, droneScale));
-    
+
+    // Create World - match physics box to sprite dimensions
+    simulationConfig config;
+    config.worldWidth = static_cast<float>(windowWidth);
+    config.worldHeight = static_cast<float>(windowHeight);
+    config.droneWidth = texSize.x * droneScale;
+    config.droneHeight = texSize.y * droneScale;
+    config.timeStep = 1.0f / opts.physicsRate;
+    config.controller = opts.controller;
+    config.useEstimator = opts.useEstimator;
+    config.motorCount = opts.motors;
+    config.multithreadedPhysics = opts.parallelPhysics;
+    configureAir(opts, config);
+    simulation sim(config);
+
     std::cout << "Texture size: " << texSize.x << "x" << texSize.y << std::endl;
-    std::cout << "Drone sprite dimensions: " << droneWidth << "x" << droneHeight << std::endl;
+    std::cout << "Drone sprite dimensions: " << config.droneWidth << "x" << config.droneHeight << std::endl;
+    std::cout << "Drone created with " << sim.getDrone().getMotorPositions().size() << " motors, max thrust: " << sim.getDrone().getMaxTotalThrust() << "N" << std::endl;
+    std::cout << "PID Hover Controller created with Kp: " << config.kp << ", Ki: " << config.ki << ", Kd: " << config.kd << std::endl;
+    std::cout << "Active controller: " << controllerName(config.controller) << " (C cycles hover/cascade/mppi)" << std::endl;
 
-    // Create Bodies - match physics box to sprite dimensions
-    // Ground surface is at ~15 (ground center 5 + half height 10), start drone just above it
-    float groundSurface = 15.0f + droneHeight / 2.0f;
-    
-    // Calculate density to maintain similar mass to original 50x50 body
-    // Original area = 50*50 = 2500, original density = 1.0, so original mass ~ 2500
-    float originalArea = 50.0f * 50.0f;
-    float newArea = droneWidth * droneHeight;
-    float adjustedDensity = originalArea / newArea; // Keep mass similar
-    
-    body droneBody = body(worldId, {halfWidth, groundSurface}, droneHeight, droneWidth, b2_dynamicBody, true, adjustedDensity);
     // Don't add droneBody to drawer - we'll draw the sprite instead
-    std::cout << "Drone body created at position: " << halfWidth << ", " << groundSurface << std::endl;
-    std::cout << "Drone dimensions: " << droneWidth << "x" << droneHeight << ", density: " << adjustedDensity << std::endl;
-
-    body ground = body(worldId, {halfWidth,  5.0f}, 10.0f, 2 * windowWidth, b2_staticBody);
-    drawer.addShape(ground);
-    std::cout << "Ground created at position: " << halfWidth << ", " << 5.0f << std::endl;
-
-    // Create Drone - motor positions at the rotor locations (ends of the arms)
-    // Rotors are at approximately 45% from center on each side based on image
-    float motorOffsetX = droneWidth * 0.45f;
-    float motorOffsetY = droneHeight * 0.3f; // Slightly above center where rotors are
-    std::vector<b2Vec2> motorLocal = { 
-        { -motorOffsetX, motorOffsetY }, { motorOffsetX, motorOffsetY }
-    };
-    std::vector<b2Vec2> motorDirections = {
-        { 0.0f, 1.0f }, { 0.0f, 1.0f }
-    };
-    drone testDrone = drone(&droneBody, motorLocal, motorDirections, 20000.0f);
-    std::cout << "Drone created with " << motorLocal.size() << " motors, max thrust: " << testDrone.getMaxTotalThrust() << "N" << std::endl;
-
-    // Create PID Controller
-    bool enabled = true;
-    float kp = 1.0f;
-    float ki = 0.0005f;
-    float kd = 200.0f;
-    pid::hoverController hover = pid::hoverController(&testDrone, kp, ki, kd);
-    std::cout << "PID Hover Controller created with Kp: " << kp << ", Ki: " << ki << ", Kd: " << kd << std::endl;
-
-    // Target altitude - start at ground level
-    float targetAltitude = groundSurface;
+    drawer.addShape(sim.getEntities(), sim.getGroundEntity());
     // add line shape to drawer to indicate target altitude
-    body targetLine = body(worldId, {halfWidth, targetAltitude}, 2.0f, 2 * windowWidth, b2_kinematicBody, false);
-    sf::Color red = sf::Color(255, 0, 0);
-    drawer.addShape(targetLine, &red);
+    drawer.addShape(sim.getEntities(), sim.getTargetEntity());
+
+    // Physics and control run on their own thread; rendering reads snapshots only
+    flightRecorder recorder;
+    if (!openRecorder(opts, recorder, config.timeStep)) {
+        return 1;
+    }
+    physicsLoop physics(sim, opts.physicsRate, 4, std::chrono::microseconds(opts.spinMicros));
+    for (entityHandle shape : drawer.getShapes()) {
+        physics.track(shape);
+    }
+    if (recorder.isOpen()) {
+        physics.setRecorder(&recorder);
+    }
+    telemetryServer telemetryLink;
+    if (!openTelemetry(opts, telemetryLink, &physics)) {
+        return 1;
+    }
+    if (opts.telemetryPort >= 0) {
+        physics.setObserver(&telemetryLink);
+    }
+    physics.start();
+    std::cout << "Physics thread running at " << opts.physicsRate << " Hz" << std::endl;
 
     // Create Force Arrow Drawer for visualizing forces
     ForceArrowDrawer forceDrawer(0.3f, 12.0f); // scale factor and arrow head size
     bool showForces = true; // Toggle with 'F' key
+    bool showMotorThrusts = false; // Toggle with 'T' key
+    // Wheel zooms at the cursor, left drag pans, V toggles following the drone, R resets the view
+    camera& cam = drawer.getCamera();
+    const camera homeCamera = cam;
+    bool dragging = false;
+    sf::Vector2i dragFrom;
+    auto lastFrameTime = std::chrono::steady_clock::now();
+    ProfilerOverlay profilerOverlay; // Toggle with 'O' key, 'P' dumps trace.json
+    frameLimiter limiter(opts.frameRate, std::chrono::microseconds(opts.spinMicros));
+
+    // Render one publish interval behind the newest snapshot and interpolate towards it.
+    // start() has already published the initial state, so this picks it up.
+    physics.update();
+    worldSnapshot previous = physics.latest();
+    worldSnapshot current = physics.latest();
+    worldSnapshot view;
+    auto currentArrival = std::chrono::steady_clock::now();
+    const double physicsPeriod = 1.0 / opts.physicsRate;
 
-    // Simulation loop (replace your previous loop)
-    const float timeStep = 1.0f / 30.0f;
-    const int32_t subStepCount = 6;
     while (drawer.isOpen() && !g_stop) {
-        if (std::optional<sf::Event> event = drawer.pollEvent()) {
-            if (event->is<sf::Event::Closed>()) {
-                drawer.close();
-                g_stop = 1;
-                break;
-            }
+        PROFILE_ZONE("frame");
+        {
+            // Drain everything queued since the last frame so input never lags behind
+            PROFILE_ZONE("events");
+            while (std::optional<sf::Event> event = drawer.pollEvent()) {
+                if (event->is<sf::Event::Closed>()) {
+                    drawer.close();
+                    g_stop = 1;
+                    break;
+                }
 
-            if (const auto keyPressed = event->getIf<sf::Event::KeyPressed>()) {
-                if (keyPressed->scancode == sf::Keyboard::Scancode::Space) {
-                    enabled = !enabled;
-                    std::cout << "PID Controller " << (enabled ? "Enabled" : "Disabled") << std::endl;
+                if (const auto wheel = event->getIf<sf::Event::MouseWheelScrolled>()) {
+                    if (wheel->wheel == sf::Mouse::Wheel::Vertical) {
+                        cam.zoomAt(std::pow(1.15f, wheel->delta), sf::Vector2f(wheel->position), drawer.getTarget().getSize());
+                    }
+                }
+                if (const auto pressed = event->getIf<sf::Event::MouseButtonPressed>()) {
+                    if (pressed->button == sf::Mouse::Button::Left) {
+                        dragging = true;
+                        dragFrom = pressed->position;
+                    }
                 }
-                if (keyPressed->scancode == sf::Keyboard::Scancode::F) {
-                    showForces = !showForces;
-                    std::cout << "Force Arrows " << (showForces ? "Enabled" : "Disabled") << std::endl;
+                if (const auto released = event->getIf<sf::Event::MouseButtonReleased>()) {
+                    if (released->button == sf::Mouse::Button::Left) {
+                        dragging = false;
+                    }
                 }
-                if (keyPressed->scancode == sf::Keyboard::Scancode::Up) {
-                    targetAltitude += 10.0f;
-                    b2Body_SetTransform(targetLine.bodyId, {halfWidth, targetAltitude}, b2MakeRot(0.0f));
-                    std::cout << "Target Altitude: " << targetAltitude << std::endl;
+                if (const auto moved = event->getIf<sf::Event::MouseMoved>()) {
+                    if (dragging) {
+                        cam.pan(sf::Vector2f(moved->position - dragFrom));
+                        dragFrom = moved->position;
+                    }
                 }
-                if (keyPressed->scancode == sf::Keyboard::Scancode::Down) {
-                    targetAltitude -= 10.0f;
-                    if (targetAltitude < 0.0f) targetAltitude = 0.0f;
-                    b2Body_SetTransform(targetLine.bodyId, {halfWidth, targetAltitude}, b2MakeRot(0.0f));
-                    std::cout << "Target Altitude: " << targetAltitude << std::endl;
+
+                if (const auto keyPressed = event->getIf<sf::Event::KeyPressed>()) {
+                    if (keyPressed->scancode == sf::Keyboard::Scancode::V) {
+                        cam.setMode(cam.getMode() == cameraMode::follow ? cameraMode::free : cameraMode::follow);
+                        std::cout << "Camera " << (cam.getMode() == cameraMode::follow ? "following the drone" : "free") << std::endl;
+                    }
+                    if (keyPressed->scancode == sf::Keyboard::Scancode::R) {
+                        cam = homeCamera;
+                    }
+                    if (keyPressed->scancode == sf::Keyboard::Scancode::K) {
+                        droneSkin = (droneSkin + 1) % droneAtlas.size();
+                        std::cout << "Drone skin: " << droneAtlas.getName(droneSkin) << std::endl;
+                    }
+                    if (keyPressed->scancode == sf::Keyboard::Scancode::Space) {
+                        physics.setControllerEnabled(!physics.isControllerEnabled());
+                        std::cout << "PID Controller " << (physics.isControllerEnabled() ? "Enabled" : "Disabled") << std::endl;
+                    }
+                    if (keyPressed->scancode == sf::Keyboard::Scancode::C) {
+                        controllerKind next = static_cast<controllerKind>((static_cast<int>(physics.getControllerKind()) + 1) % 3);
+                        physics.setControllerKind(next);
+                        std::cout << "Controller: " << controllerName(next) << std::endl;
+                    }
+                    if (keyPressed->scancode == sf::Keyboard::Scancode::F) {
+                        showForces = !showForces;
+                        std::cout << "Force Arrows " << (showForces ? "Enabled" : "Disabled") << std::endl;
+                    }
+                    if (keyPressed->scancode == sf::Keyboard::Scancode::T) {
+                        showMotorThrusts = !showMotorThrusts;
+                        std::cout << "Motor Thrust Arrows " << (showMotorThrusts ? "Enabled" : "Disabled") << std::endl;
+                    }
+                    if (keyPressed->scancode == sf::Keyboard::Scancode::O) {
+                        profilerOverlay.setVisible(!profilerOverlay.isVisible());
+                    }
+                    if (keyPressed->scancode == sf::Keyboard::Scancode::P) {
+                        writeTrace(opts.tracePath.empty() ? "trace.json" : opts.tracePath);
+                    }
+                    if (keyPressed->scancode == sf::Keyboard::Scancode::Up) {
+                        physics.setTargetAltitude(physics.getTargetAltitude() + 10.0f);
+                        std::cout << "Target Altitude: " << physics.getTargetAltitude() << std::endl;
+                    }
+                    if (keyPressed->scancode == sf::Keyboard::Scancode::Down) {
+                        physics.setTargetAltitude(std::max(physics.getTargetAltitude() - 10.0f, 0.0f));
+                        std::cout << "Target Altitude: " << physics.getTargetAltitude() << std::endl;
+                    }
                 }
             }
         }
-
-        if (enabled) {
-            hover.update(targetAltitude, timeStep);
+        if (!drawer.isOpen()) {
+            break;
         }
 
-        // Advance physics
-        b2World_Step(worldId, timeStep, subStepCount);
+        auto now = std::chrono::steady_clock::now();
+        if (physics.update()) {
+            std::swap(previous, current);
+            current = physics.latest();
+            currentArrival = now;
+        }
+        // A wake-up that caught up on several steps publishes once, so the interval
+        // between snapshots is their step difference, not always one period
+        double interval = std::max<uint64_t>(current.step - previous.step, 1) * physicsPeriod;
+        double sinceArrival = std::chrono::duration<double>(now - currentArrival).count();
+        float alpha = static_cast<float>(std::clamp(sinceArrival / interval, 0.0, 1.0));
+        interpolate(previous, current, alpha, view);
+        cam.follow(view.droneState.transform.p, static_cast<float>(std::chrono::duration<double>(now - lastFrameTime).count()));
+        lastFrameTime = now;
 
         // Render
         drawer.clear();
-        drawer.drawShapes();
-        
-        // Draw drone sprite at physics body position
-        b2Vec2 dronePos = b2Body_GetPosition(droneBody.bodyId);
-        b2Rot droneRot = b2Body_GetRotation(droneBody.bodyId);
-        float droneAngle = b2Rot_GetAngle(droneRot);
-        
-        sf::Vector2f spritePos = drawer.toWindowLocation(dronePos.x, dronePos.y);
-        droneSprite.setPosition(spritePos);
-        droneSprite.setRotation(sf::degrees(-droneAngle * 180.0f / 3.14159f)); // Convert radians to degrees, negate for SFML
-        drawer.getWindow().draw(droneSprite);
+        {
+            PROFILE_ZONE("drawShapes");
+            drawer.drawShapes(view.bodyTransforms);
+        }
         
-        if (showForces) {
-            forceDrawer.addNetForce(drawer.getWindow(),
-                [&drawer](float x, float y) { return drawer.toWindowLocation(x, y); },
-                testDrone, droneBody,
-                sf::Color::Magenta,
-                sf::Color::Cyan,
-                sf::Color::Yellow);
+        // Draw drone sprite at snapshot position
+        {
+            PROFILE_ZONE("sprite");
+            b2Vec2 dronePos = view.droneState.transform.p;
+            float droneAngle = b2Rot_GetAngle(view.droneState.transform.q);
+            
+            sf::Vector2f spritePos = drawer.toWindowLocation(dronePos.x, dronePos.y);
+            // Convert radians to degrees, negate for SFML
+            droneSprites.add(droneSkin, spritePos, sf::degrees(-droneAngle * 180.0f / 3.14159f), droneScale * cam.getZoom());
+            droneSprites.flush(drawer.getTarget());
         }
         
-        drawer.display();
+        {
+            PROFILE_ZONE("forceArrows");
+            viewTransform windowView = drawer.getViewTransform();
+            if (showForces) {
+                forceDrawer.addNetForce(view.droneState, windowView,
+                    sf::Color::Magenta,
+                    sf::Color::Cyan,
+                    sf::Color::Yellow);
+            }
+            if (showMotorThrusts) {
+                forceDrawer.addMotorThrusts(std::span<const droneSnapshot>(&view.droneState, 1), windowView);
+            }
+            forceDrawer.flush(drawer.getTarget());
+        }
+
+        profilerOverlay.update();
+        profilerOverlay.draw(drawer.getTarget());
+        {
+            PROFILE_ZONE("display");
+            drawer.display();
+        }
+        limiter.wait();
     }
 
+    physics.stop();
+    if (!opts.tracePath.empty()) {
+        writeTrace(opts.tracePath);
+    }
+    printSchedulerStats("Physics", physics.getSchedulerStats());
+    printSchedulerStats("Render", limiter.getStats());
+    if (opts.telemetryPort >= 0) {
+        printTelemetryStats(telemetryLink.getStats());
+    }
     if (drawer.isOpen()) drawer.close();
     return 0;
 }
@@ -0,0 +1,10 @@
+#include "../include/assets.hpp"
+
+const embeddedAsset* findAsset(std::string_view name) {
+    for (size_t i = 0; i < embeddedAssetCount; ++i) {
+        if (name == embeddedAssetTable[i].name) {
+            return &embeddedAssetTable[i];
+        }
+    }
+    return nullptr;
+}
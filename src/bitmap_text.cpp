@@ -0,0 +1,102 @@
+#include <cctype>
+#include <cstdint>
+#include <string_view>
+#include "../include/bitmap_text.hpp"
+
+static constexpr std::string_view glyphChars = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.:-_/%+()=,";
+
+// One byte per row, lowest five bits are the columns left to right
+static constexpr uint8_t glyphRows[][7] = {
+    { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E }, // 0
+    { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E }, // 1
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F }, // 2
+    { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E }, // 3
+    { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 }, // 4
+    { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E }, // 5
+    { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E }, // 6
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 }, // 7
+    { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E }, // 8
+    { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }, // 9
+    { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // A
+    { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E }, // B
+    { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E }, // C
+    { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C }, // D
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F }, // E
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 }, // F
+    { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F }, // G
+    { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // H
+    { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, // I
+    { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C }, // J
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 }, // K
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F }, // L
+    { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 }, // M
+    { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 }, // N
+    { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // O
+    { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 }, // P
+    { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D }, // Q
+    { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 }, // R
+    { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E }, // S
+    { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // T
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // U
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 }, // V
+    { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A }, // W
+    { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 }, // X
+    { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 }, // Y
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F }, // Z
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C }, // .
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 }, // :
+    { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 }, // -
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F }, // _
+    { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 }, // /
+    { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 }, // %
+    { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 }, // +
+    { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 }, // (
+    { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 }, // )
+    { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 }, // =
+    { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 }, // ,
+};
+static_assert(sizeof(glyphRows) / sizeof(glyphRows[0]) == glyphChars.size());
+
+static constexpr float advance = 6.0f; // glyph width plus one pixel of spacing
+
+void appendRect(sf::VertexArray& triangles, sf::Vector2f position, sf::Vector2f size, sf::Color color) {
+    sf::Vector2f topRight = { position.x + size.x, position.y };
+    sf::Vector2f bottomLeft = { position.x, position.y + size.y };
+    sf::Vector2f bottomRight = position + size;
+    triangles.append(sf::Vertex{position, color});
+    triangles.append(sf::Vertex{topRight, color});
+    triangles.append(sf::Vertex{bottomLeft, color});
+    triangles.append(sf::Vertex{bottomLeft, color});
+    triangles.append(sf::Vertex{topRight, color});
+    triangles.append(sf::Vertex{bottomRight, color});
+}
+
+void appendText(sf::VertexArray& triangles, sf::Vector2f position, std::string_view text, float pixelSize, sf::Color color) {
+    float x = position.x;
+    for (char c : text) {
+        size_t glyph = glyphChars.find(static_cast<char>(std::toupper(static_cast<unsigned char>(c))));
+        if (glyph != std::string_view::npos) {
+            for (int row = 0; row < 7; ++row) {
+                uint8_t bits = glyphRows[glyph][row];
+                // Merge horizontal runs of set pixels into one rectangle
+                for (int col = 0; col < 5;) {
+                    if (!(bits & (0x10 >> col))) {
+                        ++col;
+                        continue;
+                    }
+                    int start = col;
+                    while (col < 5 && (bits & (0x10 >> col))) {
+                        ++col;
+                    }
+                    appendRect(triangles, { x + start * pixelSize, position.y + row * pixelSize },
+                               { (col - start) * pixelSize, pixelSize }, color);
+                }
+            }
+        }
+        x += advance * pixelSize;
+    }
+}
+
+float textWidth(std::string_view text, float pixelSize) {
+    return text.size() * advance * pixelSize;
+}
@@ -1,36 +1,133 @@
 #include <box2d/box2d.h>
 #include <vector>
+#include <cmath>
+#include <iostream>
 #include "../include/body.hpp"
 
-body::body(b2WorldId worldId, b2Vec2 position, float height, float width, b2BodyType type, bool collide, float density) {
+body::body() {
+    shapeCount = 0;
+    bodyId = b2_nullBodyId;
+}
+
+body::body(b2WorldId worldId, b2Vec2 position, float height, float width, b2BodyType type, bool collide, float density)
+    : body(worldId, position, type) {
+    addBox(height, width, {0.0f, 0.0f}, 0.0f, collide, density);
+}
+
+body::body(b2WorldId worldId, b2Vec2 position, b2BodyType type) {
+    shapeCount = 0;
     b2BodyDef bodyDef = b2DefaultBodyDef();
     bodyDef.position = position;
     bodyDef.type = type;
     bodyId = b2CreateBody(worldId, &bodyDef);
+}
 
-    b2Polygon polygon = b2MakeBox(width / 2, height / 2);
-
+b2ShapeDef body::makeShapeDef(float density, bool collide) const {
     b2ShapeDef shapeDef = b2DefaultShapeDef();
     shapeDef.density = density;
     shapeDef.material.friction = 0.3f;
     if (!collide) {
         shapeDef.isSensor = true;
     }
-    shapeId = b2CreatePolygonShape(bodyId, &shapeDef, &polygon);
+    return shapeDef;
 }
 
-b2Polygon body::getPolygon() {
-    return b2Shape_GetPolygon(shapeId);;
+bool body::hasRoom() const {
+    if (shapeCount == maxBodyShapes) {
+        std::cerr << "A body holds at most " << maxBodyShapes << " shapes" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int body::addBox(float height, float width, b2Vec2 center, float angle, bool collide, float density) {
+    if (!hasRoom()) {
+        return -1;
+    }
+    b2Polygon polygon = b2MakeOffsetBox(width / 2, height / 2, center, b2MakeRot(angle));
+    b2ShapeDef shapeDef = makeShapeDef(density, collide);
+    shapeIds[shapeCount] = b2CreatePolygonShape(bodyId, &shapeDef, &polygon);
+    return shapeCount++;
+}
+
+int body::addCircle(b2Vec2 center, float radius, bool collide, float density) {
+    if (!hasRoom()) {
+        return -1;
+    }
+    b2Circle circle = { center, radius };
+    b2ShapeDef shapeDef = makeShapeDef(density, collide);
+    shapeIds[shapeCount] = b2CreateCircleShape(bodyId, &shapeDef, &circle);
+    return shapeCount++;
+}
+
+int body::addCapsule(b2Vec2 center1, b2Vec2 center2, float radius, bool collide, float density) {
+    if (!hasRoom()) {
+        return -1;
+    }
+    b2Capsule capsule = { center1, center2, radius };
+    b2ShapeDef shapeDef = makeShapeDef(density, collide);
+    shapeIds[shapeCount] = b2CreateCapsuleShape(bodyId, &shapeDef, &capsule);
+    return shapeCount++;
+}
+
+b2Polygon body::getPolygon(int shape) {
+    return b2Shape_GetPolygon(shapeIds[shape]);
+}
+
+shapeOutline body::getLocalOutline(int shape) const {
+    const float pi = 3.14159265f;
+    shapeOutline outline;
+    b2ShapeId shapeId = shapeIds[shape];
+
+    switch (b2Shape_GetType(shapeId)) {
+    case b2_circleShape: {
+        b2Circle circle = b2Shape_GetCircle(shapeId);
+        outline.count = maxShapeVertices;
+        for (int i = 0; i < maxShapeVertices; ++i) {
+            float angle = 2.0f * pi * i / maxShapeVertices;
+            outline.vertices[i] = { circle.center.x + circle.radius * std::cos(angle), circle.center.y + circle.radius * std::sin(angle) };
+        }
+        break;
+    }
+    case b2_capsuleShape: {
+        // Half the vertices on each end cap, swept around the capsule axis
+        b2Capsule capsule = b2Shape_GetCapsule(shapeId);
+        float axis = std::atan2(capsule.center2.y - capsule.center1.y, capsule.center2.x - capsule.center1.x);
+        int perCap = maxShapeVertices / 2;
+        outline.count = 2 * perCap;
+        for (int i = 0; i < perCap; ++i) {
+            float angle = axis - pi / 2.0f + pi * i / (perCap - 1);
+            outline.vertices[i] = { capsule.center2.x + capsule.radius * std::cos(angle), capsule.center2.y + capsule.radius * std::sin(angle) };
+            outline.vertices[perCap + i] = { capsule.center1.x - capsule.radius * std::cos(angle), capsule.center1.y - capsule.radius * std::sin(angle) };
+        }
+        break;
+    }
+    case b2_polygonShape: {
+        b2Polygon polygon = b2Shape_GetPolygon(shapeId);
+        outline.count = polygon.count;
+        for (int i = 0; i < polygon.count; ++i) {
+            outline.vertices[i] = polygon.vertices[i];
+        }
+        break;
+    }
+    default:
+        outline.count = 0;
+        break;
+    }
+    return outline;
+}
+
+int body::getTransformedVertices(int shape, b2Vec2* out) const {
+    shapeOutline outline = getLocalOutline(shape);
+    b2Transform transform = b2Body_GetTransform(bodyId);
+    for (int i = 0; i < outline.count; ++i) {
+        out[i] = b2TransformPoint(transform, outline.vertices[i]);
+    }
+    return outline.count;
 }
 
 std::vector<b2Vec2> body::getTransformedVertices() {
-    b2Polygon polygon = getPolygon();
-    std::vector<b2Vec2> transformedVertices;
-    
-    for (int i = 0; i < polygon.count; ++i) {
-        b2Vec2 localVertex = polygon.vertices[i];
-        b2Vec2 worldVertex = b2Body_GetWorldPoint(bodyId, localVertex);
-        transformedVertices.push_back(worldVertex);
-    }
-    return transformedVertices;
-}
\ No newline at end of file
+    b2Vec2 vertices[maxShapeVertices];
+    int count = getTransformedVertices(0, vertices);
+    return std::vector<b2Vec2>(vertices, vertices + count);
+}
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include "../include/branching.hpp"
+#include "../include/thread_pool.hpp"
+
+static bool sameBits(const bodyState& a, const bodyState& b) {
+    return std::memcmp(&a.transform, &b.transform, sizeof(a.transform)) == 0
+        && std::memcmp(&a.linearVelocity, &b.linearVelocity, sizeof(a.linearVelocity)) == 0
+        && std::memcmp(&a.angularVelocity, &b.angularVelocity, sizeof(a.angularVelocity)) == 0;
+}
+
+static void runTrajectory(simulation& sim, int steps, std::vector<bodyState>& out) {
+    out.clear();
+    for (int i = 0; i < steps; ++i) {
+        sim.step();
+        out.push_back(captureBodyState(sim.getDroneBody().bodyId));
+    }
+}
+
+static void compareTrajectories(const std::vector<bodyState>& expected, const std::vector<bodyState>& actual,
+                                uint64_t firstStep, bool& bitExact, determinismReport& report) {
+    bitExact = expected.size() == actual.size();
+    for (size_t i = 0; i < expected.size() && i < actual.size(); ++i) {
+        if (!sameBits(expected[i], actual[i])) {
+            if (bitExact && (report.firstDivergentStep < 0 || static_cast<int64_t>(firstStep + i) < report.firstDivergentStep)) {
+                report.firstDivergentStep = static_cast<int64_t>(firstStep + i);
+            }
+            bitExact = false;
+        }
+        float dx = expected[i].transform.p.x - actual[i].transform.p.x;
+        float dy = expected[i].transform.p.y - actual[i].transform.p.y;
+        report.maxPositionError = std::max(report.maxPositionError, std::sqrt(dx * dx + dy * dy));
+    }
+}
+
+determinismReport verifyDeterminism(const simulationConfig& config, int warmupSteps, int compareSteps) {
+    determinismReport report = { static_cast<uint64_t>(compareSteps), false, false, -1, 0.0f };
+
+    simulation original(config);
+    original.setTargetAltitude(original.getTargetAltitude() + 50.0f);
+    for (int i = 0; i < warmupSteps; ++i) {
+        original.step();
+    }
+    checkpoint saved;
+    original.saveCheckpoint(saved);
+
+    std::vector<bodyState> expected;
+    expected.reserve(compareSteps);
+    runTrajectory(original, compareSteps, expected);
+
+    std::vector<bodyState> actual;
+    actual.reserve(compareSteps);
+
+    simulation fresh(config);
+    fresh.restoreCheckpoint(saved);
+    runTrajectory(fresh, compareSteps, actual);
+    compareTrajectories(expected, actual, saved.step + 1, report.freshWorldBitExact, report);
+
+    original.restoreCheckpoint(saved);
+    runTrajectory(original, compareSteps, actual);
+    compareTrajectories(expected, actual, saved.step + 1, report.rewindBitExact, report);
+    return report;
+}
+
+std::vector<bodyState> forkContinuations(const simulationConfig& config, const checkpoint& from,
+                                         const std::vector<float>& targetAltitudes, int steps,
+                                         unsigned int threadCount) {
+    std::vector<bodyState> results(targetAltitudes.size());
+    std::atomic<size_t> next = 0;
+
+    simulationConfig forkConfig = config;
+    forkConfig.multithreadedPhysics = false; // each fork runs inside a pool task
+    auto worker = [&]() {
+        simulation sim(forkConfig);
+        for (size_t i = next++; i < targetAltitudes.size(); i = next++) {
+            sim.restoreCheckpoint(from);
+            sim.setTargetAltitude(targetAltitudes[i]);
+            for (int s = 0; s < steps; ++s) {
+                sim.step();
+            }
+            results[i] = captureBodyState(sim.getDroneBody().bodyId);
+        }
+    };
+
+    // Box2D caps the number of live worlds, and each thread holds one
+    threadPool& pool = sharedThreadPool();
+    size_t slots = threadCount ? threadCount : pool.concurrency();
+    slots = std::min<size_t>({ slots, pool.concurrency(), 64u, targetAltitudes.size() });
+    pool.parallelFor(slots, 1, [&](size_t begin, size_t end) {
+        for (; begin < end; ++begin) {
+            worker();
+        }
+    });
+    return results;
+}
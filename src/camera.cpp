@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <cmath>
+#include "../include/camera.hpp"
+
+camera::camera(b2Vec2 center, float zoom) {
+    this->center = center;
+    this->zoom = std::clamp(zoom, minZoom, maxZoom);
+    this->mode = cameraMode::free;
+    this->followRate = 4.0f;
+}
+
+void camera::setZoom(float zoom) {
+    this->zoom = std::clamp(zoom, minZoom, maxZoom);
+}
+
+void camera::pan(sf::Vector2f pixels) {
+    mode = cameraMode::free;
+    center.x -= pixels.x / zoom;
+    center.y += pixels.y / zoom;
+}
+
+void camera::zoomAt(float factor, sf::Vector2f pixel, sf::Vector2u viewport) {
+    b2Vec2 anchor = toWorld(pixel, viewport);
+    float previous = zoom;
+    setZoom(zoom * factor);
+    // The anchor's offset from the center shrinks or grows with the zoom change
+    float ratio = previous / zoom;
+    center.x = anchor.x + (center.x - anchor.x) * ratio;
+    center.y = anchor.y + (center.y - anchor.y) * ratio;
+}
+
+void camera::follow(b2Vec2 target, float dt) {
+    if (mode != cameraMode::follow) {
+        return;
+    }
+    float blend = 1.0f - std::exp(-followRate * dt);
+    center.x += (target.x - center.x) * blend;
+    center.y += (target.y - center.y) * blend;
+}
+
+viewTransform camera::getView(sf::Vector2u viewport) const {
+    viewTransform view;
+    view.scale = zoom;
+    view.offsetX = viewport.x / 2.0f - center.x * zoom;
+    view.offsetY = viewport.y / 2.0f + center.y * zoom;
+    return view;
+}
+
+b2Vec2 camera::toWorld(sf::Vector2f pixel, sf::Vector2u viewport) const {
+    return { center.x + (pixel.x - viewport.x / 2.0f) / zoom, center.y - (pixel.y - viewport.y / 2.0f) / zoom };
+}
+
+b2AABB camera::visibleBounds(sf::Vector2u viewport, float marginPixels) const {
+    float halfWidth = (viewport.x / 2.0f + marginPixels) / zoom;
+    float halfHeight = (viewport.y / 2.0f + marginPixels) / zoom;
+    return { { center.x - halfWidth, center.y - halfHeight }, { center.x + halfWidth, center.y + halfHeight } };
+}
@@ -0,0 +1,18 @@
+#include <box2d/box2d.h>
+#include "../include/checkpoint.hpp"
+
+bodyState captureBodyState(b2BodyId bodyId) {
+    bodyState state;
+    state.transform = b2Body_GetTransform(bodyId);
+    state.linearVelocity = b2Body_GetLinearVelocity(bodyId);
+    state.angularVelocity = b2Body_GetAngularVelocity(bodyId);
+    state.awake = b2Body_IsAwake(bodyId);
+    return state;
+}
+
+void restoreBodyState(b2BodyId bodyId, const bodyState& state) {
+    b2Body_SetTransform(bodyId, state.transform.p, state.transform.q);
+    b2Body_SetLinearVelocity(bodyId, state.linearVelocity);
+    b2Body_SetAngularVelocity(bodyId, state.angularVelocity);
+    b2Body_SetAwake(bodyId, state.awake);
+}
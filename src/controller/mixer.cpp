@@ -0,0 +1,169 @@
+#include "../../include/controller/mixer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+using namespace control;
+
+// Drones per pass of the batched mix; the chunk's per-motor rows fit on the stack
+static const size_t mixChunk = 64;
+
+motorMixer::motorMixer(std::span<const b2Vec2> motorPositions, std::span<const b2Vec2> motorDirections, float maxThrustPerMotor) {
+    int n = static_cast<int>(std::min(motorPositions.size(), motorDirections.size()));
+    if (n == 0 || n > maxMixerMotors) {
+        std::cerr << "Motor mixer supports 1 to " << maxMixerMotors << " motors, got " << n << std::endl;
+        return;
+    }
+
+    // Collective is measured along the mean thrust direction
+    b2Vec2 axis = { 0.0f, 0.0f };
+    for (int i = 0; i < n; ++i) {
+        axis.x += motorDirections[i].x;
+        axis.y += motorDirections[i].y;
+    }
+    float length = std::sqrt(axis.x * axis.x + axis.y * axis.y);
+    axis = length > 0.0f ? b2Vec2{ axis.x / length, axis.y / length } : b2Vec2{ 0.0f, 1.0f };
+
+    float arm[maxMixerMotors];
+    float cc = 0.0f, ct = 0.0f, tt = 0.0f; // entries of A * A^T
+    for (int i = 0; i < n; ++i) {
+        collectiveGain[i] = motorDirections[i].x * axis.x + motorDirections[i].y * axis.y;
+        arm[i] = motorPositions[i].x * motorDirections[i].y - motorPositions[i].y * motorDirections[i].x;
+        cc += collectiveGain[i] * collectiveGain[i];
+        ct += collectiveGain[i] * arm[i];
+        tt += arm[i] * arm[i];
+    }
+    if (cc <= 0.0f) {
+        std::cerr << "Motor mixer: no motor contributes to collective thrust" << std::endl;
+        return;
+    }
+
+    // Pseudo-inverse A^T (A A^T)^-1; without torque authority only collective is allocated
+    float det = cc * tt - ct * ct;
+    bool hasTorque = tt > 0.0f && det > 1.0e-6f * cc * tt;
+    for (int i = 0; i < n; ++i) {
+        if (hasTorque) {
+            collectiveColumn[i] = (collectiveGain[i] * tt - arm[i] * ct) / det;
+            torqueColumn[i] = (arm[i] * cc - collectiveGain[i] * ct) / det;
+        } else {
+            collectiveColumn[i] = collectiveGain[i] / cc;
+            torqueColumn[i] = 0.0f;
+        }
+    }
+    this->motorCount = n;
+    this->maxThrust = maxThrustPerMotor;
+}
+
+bool motorMixer::operator==(const motorMixer& other) const {
+    if (motorCount != other.motorCount || maxThrust != other.maxThrust) {
+        return false;
+    }
+    for (int i = 0; i < motorCount; ++i) {
+        if (collectiveColumn[i] != other.collectiveColumn[i] || torqueColumn[i] != other.torqueColumn[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void motorMixer::mix(float collective, float torque, float* thrust) const {
+    bool saturated = false;
+    for (int i = 0; i < motorCount; ++i) {
+        thrust[i] = collectiveColumn[i] * collective + torqueColumn[i] * torque;
+        saturated |= thrust[i] < 0.0f || thrust[i] > maxThrust;
+    }
+    if (saturated) {
+        saturate(collective, torque, thrust);
+    }
+}
+
+void motorMixer::saturate(float collective, float torque, float* thrust) const {
+    // Per motor, r = torque share / collective share: the collective needed to
+    // cancel that motor's torque term. Every motor fits at some collective only
+    // if the spread of r is small enough, otherwise torque is scaled down to fit.
+    float r[maxMixerMotors];
+    float rMin = INFINITY;
+    for (int i = 0; i < motorCount; ++i) {
+        if (collectiveColumn[i] > 0.0f) {
+            r[i] = torqueColumn[i] * torque / collectiveColumn[i];
+            rMin = std::min(rMin, r[i]);
+        }
+    }
+    float scale = 1.0f;
+    for (int i = 0; i < motorCount; ++i) {
+        if (collectiveColumn[i] > 0.0f && r[i] > rMin) {
+            scale = std::min(scale, maxThrust / (collectiveColumn[i] * (r[i] - rMin)));
+        }
+    }
+    torque *= scale;
+
+    // Range of collective that keeps every motor in [0, maxThrust] at this torque
+    float low = -INFINITY;
+    float high = INFINITY;
+    for (int i = 0; i < motorCount; ++i) {
+        if (collectiveColumn[i] > 0.0f) {
+            float torqueTerm = torqueColumn[i] * torque;
+            low = std::max(low, -torqueTerm / collectiveColumn[i]);
+            high = std::min(high, (maxThrust - torqueTerm) / collectiveColumn[i]);
+        }
+    }
+    if (low <= high) {
+        collective = std::clamp(collective, low, high);
+    }
+    for (int i = 0; i < motorCount; ++i) {
+        thrust[i] = std::clamp(collectiveColumn[i] * collective + torqueColumn[i] * torque, 0.0f, maxThrust);
+    }
+}
+
+void motorMixer::mix(const float* collective, const float* torque, size_t count, float* thrust) const {
+    const int n = motorCount;
+    float columns[maxMixerMotors][mixChunk];
+    float lowest[mixChunk];
+    float highest[mixChunk];
+    for (size_t begin = 0; begin < count; begin += mixChunk) {
+        size_t chunk = std::min(mixChunk, count - begin);
+        const float* c = collective + begin;
+        const float* t = torque + begin;
+
+        // Unconstrained allocation, one motor row at a time over contiguous commands
+        for (size_t d = 0; d < chunk; ++d) {
+            lowest[d] = INFINITY;
+            highest[d] = -INFINITY;
+        }
+        for (int m = 0; m < n; ++m) {
+            const float a = collectiveColumn[m];
+            const float b = torqueColumn[m];
+            float* column = columns[m];
+            for (size_t d = 0; d < chunk; ++d) {
+                column[d] = a * c[d] + b * t[d];
+                lowest[d] = column[d] < lowest[d] ? column[d] : lowest[d];
+                highest[d] = column[d] > highest[d] ? column[d] : highest[d];
+            }
+        }
+        float* out = thrust + begin * n;
+        for (size_t d = 0; d < chunk; ++d) {
+            for (int m = 0; m < n; ++m) {
+                out[d * n + m] = columns[m][d];
+            }
+        }
+
+        for (size_t d = 0; d < chunk; ++d) {
+            if (lowest[d] < 0.0f || highest[d] > maxThrust) {
+                saturate(c[d], t[d], out + d * n);
+            }
+        }
+    }
+}
+
+std::vector<b2Vec2> control::evenMotorPositions(int count, float halfSpan, float height) {
+    std::vector<b2Vec2> positions;
+    for (int i = 0; i < count; ++i) {
+        float x = count > 1 ? -halfSpan + 2.0f * halfSpan * i / (count - 1) : 0.0f;
+        positions.push_back({ x, height });
+    }
+    return positions;
+}
+
+std::vector<b2Vec2> control::verticalMotorDirections(int count) {
+    return std::vector<b2Vec2>(count, b2Vec2{ 0.0f, 1.0f });
+}
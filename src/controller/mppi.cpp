@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <cmath>
+#include <box2d/box2d.h>
+#include "../../include/controller/mppi.hpp"
+#include "../../include/estimation/sensors.hpp"
+#include "../../include/thread_pool.hpp"
+
+using namespace control;
+
+// Samples are rolled out in blocks of this many, with state held in stack arrays
+static constexpr size_t blockSize = 64;
+
+mppiController::mppiController(drone* controlledDrone, const mppiConfig& config) {
+    this->controlledDrone = controlledDrone;
+    this->model = makeDroneModel(*controlledDrone);
+    this->config = config;
+    this->config.samples = std::max(config.samples, 1);
+    this->config.horizon = std::max(config.horizon, 1);
+    this->config.planStep = std::max(config.planStep, 1.0e-3f);
+    reset();
+}
+
+float mppiController::hoverThrust() const {
+    float verticalAuthority = 0.0f;
+    for (int i = 0; i < model.motorCount; ++i) {
+        verticalAuthority += model.directionY[i];
+    }
+    return verticalAuthority > 0.0f ? model.mass * model.gravity / verticalAuthority : 0.0f;
+}
+
+void mppiController::reset() {
+    state.nominal.assign(static_cast<size_t>(config.horizon) * model.motorCount, hoverThrust());
+    state.iteration = 0;
+    state.timeSinceShift = 0.0f;
+    state.lastCost = 0.0f;
+}
+
+// Sample 0 keeps the unperturbed plan in the candidate set
+void mppiController::sampleNoise(size_t begin, size_t end) {
+    const size_t samples = config.samples;
+    const size_t rows = static_cast<size_t>(config.horizon) * model.motorCount;
+    const float sigma = config.noise * model.maxThrustPerMotor;
+    for (size_t k = begin; k < end; ++k) {
+        if (k == 0) {
+            for (size_t r = 0; r < rows; ++r) {
+                noise[r * samples] = 0.0f;
+            }
+            continue;
+        }
+        estimation::noiseSource rng((state.iteration + 1) * 0x9E3779B97F4A7C15ull ^ (k * 0xBF58476D1CE4E5B9ull));
+        for (size_t r = 0; r < rows; ++r) {
+            noise[r * samples + k] = sigma * rng.gaussian();
+        }
+    }
+}
+
+void mppiController::rollout(size_t begin, size_t end, const measurement& m, const setpoint& sp) {
+    const size_t samples = config.samples;
+    const int motors = model.motorCount;
+    const float h = config.planStep;
+    const float invMass = 1.0f / model.mass;
+    const float invInertia = 1.0f / model.inertia;
+    const float maxThrust = model.maxThrustPerMotor;
+    const float invMaxThrust = maxThrust > 0.0f ? 1.0f / maxThrust : 0.0f;
+    const float hover = hoverThrust();
+
+    for (size_t block = begin; block < end; block += blockSize) {
+        const size_t n = std::min(blockSize, end - block);
+        float x[blockSize], y[blockSize], angle[blockSize];
+        float velX[blockSize], velY[blockSize], angularVelocity[blockSize];
+        float forceX[blockSize], forceY[blockSize], torque[blockSize], effort[blockSize];
+        float cost[blockSize];
+        for (size_t k = 0; k < n; ++k) {
+            x[k] = m.x;
+            y[k] = m.y;
+            angle[k] = m.angle;
+            velX[k] = m.velX;
+            velY[k] = m.velY;
+            angularVelocity[k] = m.angularVelocity;
+            cost[k] = 0.0f;
+        }
+
+        for (int t = 0; t < config.horizon; ++t) {
+            std::fill(forceX, forceX + n, 0.0f);
+            std::fill(forceY, forceY + n, 0.0f);
+            std::fill(torque, torque + n, 0.0f);
+            std::fill(effort, effort + n, 0.0f);
+            for (int i = 0; i < motors; ++i) {
+                const float* eps = &noise[(static_cast<size_t>(t) * motors + i) * samples + block];
+                const float nominal = state.nominal[static_cast<size_t>(t) * motors + i];
+                const float dx = model.directionX[i];
+                const float dy = model.directionY[i];
+                const float arm = model.torqueArm[i];
+                for (size_t k = 0; k < n; ++k) {
+                    float u = std::clamp(nominal + eps[k], 0.0f, maxThrust);
+                    forceX[k] += dx * u;
+                    forceY[k] += dy * u;
+                    torque[k] += arm * u;
+                    float deviation = (u - hover) * invMaxThrust;
+                    effort[k] += deviation * deviation;
+                }
+            }
+
+            const float weight = t == config.horizon - 1 ? config.terminalWeight : 1.0f;
+            for (size_t k = 0; k < n; ++k) {
+                float c = std::cos(angle[k]);
+                float s = std::sin(angle[k]);
+                velX[k] += (c * forceX[k] - s * forceY[k]) * invMass * h;
+                velY[k] += ((s * forceX[k] + c * forceY[k]) * invMass - model.gravity) * h;
+                angularVelocity[k] += torque[k] * invInertia * h;
+                x[k] += velX[k] * h;
+                y[k] += velY[k] * h;
+                angle[k] += angularVelocity[k] * h;
+
+                float altitudeError = y[k] - sp.altitude;
+                float horizontalError = x[k] - sp.x;
+                cost[k] += weight * (config.altitudeWeight * altitudeError * altitudeError
+                                   + config.verticalVelocityWeight * velY[k] * velY[k]
+                                   + config.horizontalWeight * horizontalError * horizontalError
+                                   + config.horizontalVelocityWeight * velX[k] * velX[k]
+                                   + config.angleWeight * angle[k] * angle[k]
+                                   + config.angularVelocityWeight * angularVelocity[k] * angularVelocity[k])
+                         + config.effortWeight * effort[k];
+            }
+        }
+        std::copy(cost, cost + n, costs.begin() + block);
+    }
+}
+
+void mppiController::update(const measurement& m, const setpoint& sp, float dt) {
+    const size_t samples = config.samples;
+    const int motors = model.motorCount;
+    const size_t rows = static_cast<size_t>(config.horizon) * motors;
+    noise.resize(rows * samples);
+    costs.resize(samples);
+
+    // Chunks are whole blocks, so every block's noise and rollout stay on one thread
+    const size_t blocks = (samples + blockSize - 1) / blockSize;
+    sharedThreadPool().parallelFor(blocks, 1, [&](size_t first, size_t last) {
+        size_t begin = first * blockSize;
+        size_t end = std::min(last * blockSize, samples);
+        sampleNoise(begin, end);
+        rollout(begin, end, m, sp);
+    });
+
+    // Softmin over rollout costs; the temperature scales with the cost spread
+    float minCost = *std::min_element(costs.begin(), costs.end());
+    double meanCost = 0.0;
+    for (float c : costs) {
+        meanCost += c;
+    }
+    meanCost /= samples;
+    float lambda = config.temperature * std::max(static_cast<float>(meanCost) - minCost, 1.0e-6f);
+    float totalWeight = 0.0f;
+    for (float& c : costs) {
+        c = std::exp(-(c - minCost) / lambda);
+        totalWeight += c;
+    }
+
+    const float maxThrust = model.maxThrustPerMotor;
+    for (size_t r = 0; r < rows; ++r) {
+        const float* eps = &noise[r * samples];
+        float weighted = 0.0f;
+        for (size_t k = 0; k < samples; ++k) {
+            weighted += costs[k] * eps[k];
+        }
+        state.nominal[r] = std::clamp(state.nominal[r] + weighted / totalWeight, 0.0f, maxThrust);
+    }
+    state.lastCost = minCost;
+    ++state.iteration;
+
+    b2BodyId bodyId = controlledDrone->getBodyId();
+    b2Vec2 position = b2Body_GetPosition(bodyId);
+    b2Rot rotation = b2Body_GetRotation(bodyId);
+    for (int i = 0; i < motors; ++i) {
+        controlledDrone->applyThrust(i, state.nominal[i], position, rotation);
+    }
+
+    // Advance the plan one horizon step each time a plan step of real time passes
+    state.timeSinceShift += dt;
+    while (state.timeSinceShift >= config.planStep) {
+        state.timeSinceShift -= config.planStep;
+        std::copy(state.nominal.begin() + motors, state.nominal.end(), state.nominal.begin());
+        std::fill(state.nominal.end() - motors, state.nominal.end(), hoverThrust());
+    }
+}
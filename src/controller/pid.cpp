@@ -8,8 +8,25 @@ hoverController::hoverController(drone* controlledDrone, float kp, float ki, flo
     this->kp = kp;
     this->ki = ki;
     this->kd = kd;
-    this->integralError = 0.0f;
-    this->previousError = 0.0f;
+    reset();
+}
+
+void hoverController::reset() {
+    integralError = 0.0f;
+    previousError = 0.0f;
+    lastTerms = { 0.0f, 0.0f, 0.0f };
+}
+
+void hoverController::setState(const controllerState& state) {
+    integralError = state.integralError;
+    previousError = state.previousError;
+    lastTerms = state.lastTerms;
+}
+
+void hoverController::setGains(float kp, float ki, float kd) {
+    this->kp = kp;
+    this->ki = ki;
+    this->kd = kd;
 }
 
 float hoverController::proportional(float error) {
@@ -31,6 +48,7 @@ float hoverController::computeControl(float error, float deltaTime) {
     float p = proportional(error);
     float i = integral(error, deltaTime);
     float d = derivative(error, deltaTime);
+    lastTerms = { p, i, d };
     return p + i + d;
 }
     
@@ -42,3 +60,13 @@ void hoverController::update(float targetAltitude, float deltaTime) {
     float totalThrust = controlOutput + gravityCompensation;
     controlledDrone->applyThrustEvenly(totalThrust);
 }
+
+void hoverController::update(float targetAltitude, float altitude, float verticalVelocity, float deltaTime) {
+    float error = targetAltitude - altitude;
+    float p = proportional(error);
+    float i = integral(error, deltaTime);
+    float d = -kd * verticalVelocity;
+    previousError = error;
+    lastTerms = { p, i, d };
+    controlledDrone->applyThrustEvenly(p + i + d + controlledDrone->gravitationalForce());
+}
@@ -0,0 +1,23 @@
+#include "../../include/controller/pipeline.hpp"
+#include <box2d/box2d.h>
+
+using namespace control;
+
+measurement control::measure(drone& d) {
+    b2BodyId bodyId = d.getBodyId();
+    b2Transform transform = b2Body_GetTransform(bodyId);
+    b2Vec2 velocity = b2Body_GetLinearVelocity(bodyId);
+    measurement m;
+    m.x = transform.p.x;
+    m.y = transform.p.y;
+    m.angle = b2Rot_GetAngle(transform.q);
+    m.velX = velocity.x;
+    m.velY = velocity.y;
+    m.angularVelocity = b2Body_GetAngularVelocity(bodyId);
+    m.weight = d.gravitationalForce();
+    return m;
+}
+
+void control::applyCommand(drone& d, const command& c) {
+    d.applyWrench(c.collective, c.torque);
+}
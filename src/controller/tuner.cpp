@@ -0,0 +1,127 @@
+#include "../../include/controller/tuner.hpp"
+#include "../../include/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+using namespace pid;
+
+gainTuner::gainTuner(const simulationConfig& baseConfig, const tuningScenario& scenario, unsigned int threadCount) {
+    this->baseConfig = baseConfig;
+    this->scenario = scenario;
+    // Box2D caps the number of live worlds, and each thread holds one at a time
+    this->threadCount = threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+    this->threadCount = std::min(this->threadCount, 64u);
+}
+
+stepResponse gainTuner::evaluate(const gains& candidate) const {
+    simulationConfig config = baseConfig;
+    config.kp = candidate.kp;
+    config.ki = candidate.ki;
+    config.kd = candidate.kd;
+    config.multithreadedPhysics = false; // runs inside a pool task
+    simulation sim(config);
+
+    float start = sim.getDrone().altitude();
+    float target = start + scenario.stepHeight;
+    float band = std::abs(scenario.stepHeight) * scenario.settleBand;
+    sim.setTargetAltitude(target);
+
+    const drone& d = sim.getDrone();
+    float maxThrust = d.getMaxThrustPerMotor();
+    int steps = static_cast<int>(scenario.duration / config.timeStep);
+
+    stepResponse response = { 0.0f, 0.0f, 0.0f, 0.0f };
+    int saturatedSteps = 0;
+    for (int i = 0; i < steps; ++i) {
+        sim.step();
+        float t = (i + 1) * config.timeStep;
+        float error = target - sim.getDrone().altitude();
+
+        response.overshoot = std::max(response.overshoot, -error / scenario.stepHeight);
+        response.itae += t * std::abs(error) * config.timeStep;
+        if (std::abs(error) > band) {
+            response.settlingTime = t;
+        }
+        for (float thrust : d.getLastThrustValues()) {
+            if (thrust <= 0.0f || thrust >= maxThrust) {
+                ++saturatedSteps;
+                break;
+            }
+        }
+        if (!std::isfinite(error)) {
+            response = { INFINITY, scenario.duration, INFINITY, 1.0f };
+            return response;
+        }
+    }
+    response.saturation = steps > 0 ? static_cast<float>(saturatedSteps) / steps : 0.0f;
+    return response;
+}
+
+std::vector<tuningResult> gainTuner::sweep(const std::vector<gains>& candidates) const {
+    std::vector<tuningResult> results(candidates.size());
+    std::atomic<size_t> next = 0;
+
+    auto worker = [&]() {
+        for (size_t i = next++; i < candidates.size(); i = next++) {
+            results[i] = { candidates[i], evaluate(candidates[i]) };
+        }
+    };
+
+    // One slot per thread; each slot drains the shared index
+    threadPool& pool = sharedThreadPool();
+    size_t slots = std::min<size_t>({ threadCount, pool.concurrency(), candidates.size() });
+    pool.parallelFor(slots, 1, [&](size_t begin, size_t end) {
+        for (; begin < end; ++begin) {
+            worker();
+        }
+    });
+    return results;
+}
+
+std::vector<gains> gainTuner::logGrid(gains low, gains high, int pointsPerAxis) {
+    auto axis = [pointsPerAxis](float lo, float hi) {
+        std::vector<float> values;
+        for (int i = 0; i < pointsPerAxis; ++i) {
+            float f = pointsPerAxis > 1 ? static_cast<float>(i) / (pointsPerAxis - 1) : 0.0f;
+            values.push_back(lo > 0.0f ? lo * std::pow(hi / lo, f) : lo + (hi - lo) * f);
+        }
+        return values;
+    };
+
+    std::vector<gains> grid;
+    grid.reserve(static_cast<size_t>(pointsPerAxis) * pointsPerAxis * pointsPerAxis);
+    for (float kp : axis(low.kp, high.kp)) {
+        for (float ki : axis(low.ki, high.ki)) {
+            for (float kd : axis(low.kd, high.kd)) {
+                grid.push_back({ kp, ki, kd });
+            }
+        }
+    }
+    return grid;
+}
+
+static bool dominates(const stepResponse& a, const stepResponse& b) {
+    bool noWorse = a.overshoot <= b.overshoot && a.settlingTime <= b.settlingTime
+        && a.itae <= b.itae && a.saturation <= b.saturation;
+    bool better = a.overshoot < b.overshoot || a.settlingTime < b.settlingTime
+        || a.itae < b.itae || a.saturation < b.saturation;
+    return noWorse && better;
+}
+
+std::vector<tuningResult> gainTuner::paretoFront(const std::vector<tuningResult>& results) {
+    std::vector<tuningResult> front;
+    for (const auto& candidate : results) {
+        bool dominated = std::any_of(results.begin(), results.end(), [&](const tuningResult& other) {
+            return dominates(other.response, candidate.response);
+        });
+        if (!dominated) {
+            front.push_back(candidate);
+        }
+    }
+    std::sort(front.begin(), front.end(), [](const tuningResult& a, const tuningResult& b) {
+        return a.response.itae < b.response.itae;
+    });
+    return front;
+}
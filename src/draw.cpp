@@ -1,13 +1,34 @@
 #include <SFML/Graphics.hpp>
 #include <box2d/box2d.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
 #include "../include/body.hpp"
 #include "../include/draw.hpp"
+#include "../include/thread_pool.hpp"
 
-draw::draw(unsigned int width, unsigned int height)
+// Below this many visible shapes the pool's hand-off costs more than it saves
+static const size_t parallelOutlineThreshold = 512;
+// Grow the queried rectangle a little so shapes sliding in are never a frame late
+static const float cullMarginPixels = 8.0f;
+
+draw::draw(unsigned int width, unsigned int height, bool offscreen)
+    : viewCamera({ width / 2.0f, height / 2.0f }, 1.0f)
 {
     backgroundColor = sf::Color::Black;
-    shapeColor = sf::Color::White;
-    window.create(sf::VideoMode({width, height}), "Drone Control");
+    batch.setPrimitiveType(sf::PrimitiveType::Triangles);
+    visibleVertexCount = 0;
+    staticBatchScale = 0.0f;
+    staticShapeCount = 0;
+    staticSimplified = 0;
+    staticBatchDirty = false;
+    if (offscreen) {
+        offscreenTarget.emplace(sf::Vector2u(width, height));
+        target = &*offscreenTarget;
+    } else {
+        window.create(sf::VideoMode({width, height}), "Drone Control");
+        target = &window;
+    }
 }
 
 draw::~draw()
@@ -17,43 +38,304 @@ draw::~draw()
 
 void draw::clear()
 {
-    window.clear(backgroundColor);
+    target->clear(backgroundColor);
 }
 
-void draw::addShape(body& shape, sf::Color* color)
+draw::outlineInfo draw::makeOutlineInfo(const shapeOutline& outline, size_t owner) {
+    outlineInfo info;
+    info.full = outline;
+    info.owner = owner;
+    b2Vec2 lower = { 0.0f, 0.0f };
+    b2Vec2 upper = { 0.0f, 0.0f };
+    for (int v = 0; v < outline.count; ++v) {
+        lower = v == 0 ? outline.vertices[v] : b2Vec2{ std::min(lower.x, outline.vertices[v].x), std::min(lower.y, outline.vertices[v].y) };
+        upper = v == 0 ? outline.vertices[v] : b2Vec2{ std::max(upper.x, outline.vertices[v].x), std::max(upper.y, outline.vertices[v].y) };
+    }
+    // Half the vertices of even a box; at a few pixels the shape is indistinguishable
+    info.coarse.count = outline.count >= 3 ? 3 : 0;
+    info.coarse.vertices[0] = { lower.x, lower.y };
+    info.coarse.vertices[1] = { upper.x, lower.y };
+    info.coarse.vertices[2] = { (lower.x + upper.x) / 2.0f, upper.y };
+    info.boundsCenter = { (lower.x + upper.x) / 2.0f, (lower.y + upper.y) / 2.0f };
+    info.boundsRadius = std::sqrt((upper.x - lower.x) * (upper.x - lower.x) + (upper.y - lower.y) * (upper.y - lower.y)) / 2.0f;
+    return info;
+}
+
+bool draw::addShape(const entityRegistry& entities, entityHandle entity)
 {
-    shapes.push_back(&shape);
-    if (color) {
-        shapeColors.push_back(*color);
-    } else {
-        shapeColors.push_back(shapeColor);
+    const body* shape = entities.getBody(entity);
+    if (!shape) {
+        std::cerr << "Cannot draw an entity that no longer exists" << std::endl;
+        return false;
+    }
+    for (int i = 0; i < shape->getShapeCount(); ++i) {
+        b2ShapeId shapeId = shape->getShape(i);
+        size_t slot = static_cast<size_t>(shapeId.index1);
+        if (slot >= outlineOfShape.size()) {
+            outlineOfShape.resize(slot + 1, noOutline);
+        }
+        outlineOfShape[slot] = static_cast<uint32_t>(outlines.size());
+        if (b2Shape_IsSensor(shapeId)) {
+            sensorOutlines.push_back(outlines.size());
+        }
+        outlines.push_back(makeOutlineInfo(shape->getLocalOutline(i), shapes.size()));
+        outlines.back().shapeId = shapeId;
+    }
+    bool isStatic = b2Body_GetType(shape->bodyId) == b2_staticBody;
+    staticBatchDirty = staticBatchDirty || isStatic;
+    shapes.push_back({ entity, shape->bodyId, sf::Color(entities.getColor(entity)), isStatic,
+                       b2Body_GetTransform(shape->bodyId), static_cast<size_t>(shape->getShapeCount()) });
+    return true;
+}
+
+// Keeps the remaining entities in order, so layering does not change
+bool draw::removeShape(entityHandle entity)
+{
+    auto found = std::find_if(shapes.begin(), shapes.end(), [entity](const drawnEntity& shape) { return shape.entity == entity; });
+    if (found == shapes.end()) {
+        return false;
+    }
+    size_t owner = static_cast<size_t>(found - shapes.begin());
+    size_t first = 0;
+    while (first < outlines.size() && outlines[first].owner != owner) {
+        ++first;
+    }
+    size_t last = first + found->outlineCount;
+    for (size_t i = first; i < last; ++i) {
+        outlineOfShape[outlines[i].shapeId.index1] = noOutline;
     }
+    outlines.erase(outlines.begin() + first, outlines.begin() + last);
+    for (size_t i = first; i < outlines.size(); ++i) {
+        outlines[i].owner -= 1;
+        outlineOfShape[outlines[i].shapeId.index1] = static_cast<uint32_t>(i);
+    }
+    size_t kept = 0;
+    for (size_t i : sensorOutlines) {
+        if (i < first) {
+            sensorOutlines[kept++] = i;
+        } else if (i >= last) {
+            sensorOutlines[kept++] = i - found->outlineCount;
+        }
+    }
+    sensorOutlines.resize(kept);
+    staticBatchDirty = staticBatchDirty || found->isStatic;
+    shapes.erase(found);
+    return true;
+}
+
+std::vector<entityHandle> draw::getShapes() const
+{
+    std::vector<entityHandle> handles;
+    handles.reserve(shapes.size());
+    for (const drawnEntity& shape : shapes) {
+        handles.push_back(shape.entity);
+    }
+    return handles;
 }
 
 sf::Vector2f draw::toWindowLocation(float x, float y) {
-    return sf::Vector2f(x, window.getSize().y - y);
+    return getViewTransform().apply(x, y);
+}
+
+viewTransform draw::getViewTransform() {
+    return viewCamera.getView(target->getSize());
 }
 
 sf::ConvexShape draw::convexShape(const std::vector<b2Vec2>& shape, sf::Color color) {
+    viewTransform view = getViewTransform();
     sf::ConvexShape polygon;
     polygon.setPointCount(shape.size());
     for (int i = 0; i < shape.size(); ++i) {
-        polygon.setPoint(i, toWindowLocation(shape[i].x, shape[i].y));
+        polygon.setPoint(i, view.apply(shape[i].x, shape[i].y));
     }
     polygon.setFillColor(color);
     return polygon;
 }
 
+// Fan-triangulates a convex outline into out, returns the next free vertex
+size_t draw::writePolygon(sf::Vertex* out, size_t offset, const shapeOutline& outline, const b2Transform& transform, sf::Color color, const viewTransform& view) {
+    if (outline.count < 3) {
+        return offset;
+    }
+    b2Vec2 first = b2TransformPoint(transform, outline.vertices[0]);
+    b2Vec2 previous = b2TransformPoint(transform, outline.vertices[1]);
+    sf::Vector2f firstLocation = view.apply(first.x, first.y);
+    sf::Vector2f previousLocation = view.apply(previous.x, previous.y);
+    for (int v = 2; v < outline.count; ++v) {
+        b2Vec2 current = b2TransformPoint(transform, outline.vertices[v]);
+        sf::Vector2f currentLocation = view.apply(current.x, current.y);
+        out[offset++] = sf::Vertex{firstLocation, color};
+        out[offset++] = sf::Vertex{previousLocation, color};
+        out[offset++] = sf::Vertex{currentLocation, color};
+        previousLocation = currentLocation;
+    }
+    return offset;
+}
+
+void draw::beginVisible(size_t registered) {
+    visible.clear();
+    visibleVertexCount = 0;
+    lastStats = drawStats();
+    lastStats.registered = registered;
+}
+
+// Level of detail, by projected size only: anything a few pixels across is one triangle
+const shapeOutline& draw::levelOfDetail(const outlineInfo& info, float scale, bool& simplified) {
+    simplified = 2.0f * info.boundsRadius * scale < lodPixels;
+    return simplified ? info.coarse : info.full;
+}
+
+void draw::addVisible(const outlineInfo& info, const b2Transform& transform, sf::Color color, float scale) {
+    bool simplified;
+    const shapeOutline& outline = levelOfDetail(info, scale, simplified);
+    lastStats.simplified += simplified ? 1 : 0;
+    addVisible(outline, transform, color);
+}
+
+void draw::addVisible(const shapeOutline& outline, const b2Transform& transform, sf::Color color) {
+    if (outline.count < 3) {
+        return;
+    }
+    visible.push_back({ &outline, transform, color, visibleVertexCount });
+    visibleVertexCount += 3 * static_cast<size_t>(outline.count - 2);
+}
+
+void draw::flushVisible() {
+    viewTransform view = getViewTransform();
+    batch.resize(visibleVertexCount);
+    size_t grain = visible.size() >= parallelOutlineThreshold ? 128 : visible.size();
+    sharedThreadPool().parallelFor(visible.size(), grain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            writePolygon(&batch[0], visible[i].vertexOffset, *visible[i].outline, visible[i].transform, visible[i].color, view);
+        }
+    });
+    lastStats.drawn += visible.size();
+    lastStats.vertices += visibleVertexCount;
+    if (visibleVertexCount > 0) {
+        target->draw(batch);
+    }
+}
+
+void draw::drawStaticShapes(const viewTransform& view) {
+    if (staticBatchDirty || view.scale != staticBatchScale) {
+        // World coordinates with Y flipped; the draw call's transform adds scale and offset
+        const viewTransform world = { 1.0f, 0.0f, 0.0f };
+        size_t vertexCount = 0;
+        staticShapeCount = 0;
+        staticSimplified = 0;
+        for (const outlineInfo& info : outlines) {
+            if (shapes[info.owner].isStatic) {
+                bool simplified;
+                const shapeOutline& outline = levelOfDetail(info, view.scale, simplified);
+                vertexCount += outline.count >= 3 ? 3 * static_cast<size_t>(outline.count - 2) : 0;
+                staticShapeCount += 1;
+                staticSimplified += simplified ? 1 : 0;
+            }
+        }
+        staticBatch.resize(vertexCount);
+        size_t offset = 0;
+        for (const outlineInfo& info : outlines) {
+            const drawnEntity& owner = shapes[info.owner];
+            if (owner.isStatic) {
+                bool simplified;
+                const shapeOutline& outline = levelOfDetail(info, view.scale, simplified);
+                offset = writePolygon(staticBatch.data(), offset, outline, owner.staticTransform, owner.color, world);
+            }
+        }
+        staticBatchScale = view.scale;
+        staticBatchDirty = false;
+    }
+    lastStats.drawn += staticShapeCount;
+    lastStats.simplified += staticSimplified;
+    lastStats.vertices += staticBatch.size();
+    if (!staticBatch.empty()) {
+        sf::RenderStates states;
+        states.transform.translate({ view.offsetX, view.offsetY }).scale({ view.scale, view.scale });
+        target->draw(staticBatch.data(), staticBatch.size(), sf::PrimitiveType::Triangles, states);
+    }
+}
+
+bool draw::collectShape(b2ShapeId shapeId, void* context) {
+    draw* self = static_cast<draw*>(context);
+    // Box2D reuses shape indices, so the entry must also match the shape's generation
+    size_t slot = static_cast<size_t>(shapeId.index1);
+    if (slot < self->outlineOfShape.size() && self->outlineOfShape[slot] != noOutline) {
+        size_t i = self->outlineOfShape[slot];
+        if (B2_ID_EQUALS(self->outlines[i].shapeId, shapeId)) {
+            self->queryHits.push_back(i);
+        }
+    }
+    return true;
+}
+
+static bool overlaps(const b2AABB& a, const b2AABB& b) {
+    return a.lowerBound.x <= b.upperBound.x && b.lowerBound.x <= a.upperBound.x &&
+           a.lowerBound.y <= b.upperBound.y && b.lowerBound.y <= a.upperBound.y;
+}
+
 void draw::drawShapes() {
-    for (size_t i = 0; i < shapes.size(); ++i) {
-        std::vector<b2Vec2> polygonData = shapes[i]->getTransformedVertices();
-        sf::ConvexShape polygon = convexShape(polygonData, shapeColors[i]);
-        window.draw(polygon);
+    beginVisible(outlines.size());
+    if (shapes.empty()) {
+        return;
+    }
+    viewTransform view = getViewTransform();
+    drawStaticShapes(view);
+    b2AABB bounds = viewCamera.visibleBounds(target->getSize(), cullMarginPixels);
+    queryHits.clear();
+    b2World_OverlapAABB(b2Body_GetWorld(shapes[0].bodyId), bounds, b2DefaultQueryFilter(), &draw::collectShape, this);
+    for (size_t i : sensorOutlines) {
+        if (!shapes[outlines[i].owner].isStatic && overlaps(b2Shape_GetAABB(outlines[i].shapeId), bounds)) {
+            queryHits.push_back(i);
+        }
+    }
+    // Query order is arbitrary; keep addShape order so overlapping shapes layer the same way every frame
+    std::sort(queryHits.begin(), queryHits.end());
+    queryHits.erase(std::unique(queryHits.begin(), queryHits.end()), queryHits.end());
+
+    // Outlines of one body are contiguous, so its transform is fetched once
+    size_t cachedOwner = shapes.size();
+    b2Transform transform = {};
+    for (size_t i : queryHits) {
+        size_t owner = outlines[i].owner;
+        if (shapes[owner].isStatic) {
+            continue;
+        }
+        if (owner != cachedOwner) {
+            transform = b2Body_GetTransform(shapes[owner].bodyId);
+            cachedOwner = owner;
+        }
+        addVisible(outlines[i], transform, shapes[owner].color, view.scale);
+    }
+    flushVisible();
+}
+
+// Snapshot transforms may come from another thread's world, which must not be
+// queried while it steps, so each shape is tested against its bounding circle
+void draw::drawShapes(const std::vector<b2Transform>& transforms) {
+    beginVisible(outlines.size());
+    viewTransform view = getViewTransform();
+    drawStaticShapes(view);
+    b2AABB bounds = viewCamera.visibleBounds(target->getSize(), cullMarginPixels);
+    for (const outlineInfo& info : outlines) {
+        if (shapes[info.owner].isStatic || info.owner >= transforms.size()) {
+            continue;
+        }
+        const b2Transform& transform = transforms[info.owner];
+        b2Vec2 center = b2TransformPoint(transform, info.boundsCenter);
+        b2AABB shapeBounds = { { center.x - info.boundsRadius, center.y - info.boundsRadius }, { center.x + info.boundsRadius, center.y + info.boundsRadius } };
+        if (overlaps(shapeBounds, bounds)) {
+            addVisible(info, transform, shapes[info.owner].color, view.scale);
+        }
     }
+    flushVisible();
 }
 
 void draw::display() {
-    window.display();
+    if (offscreenTarget) {
+        offscreenTarget->display();
+    } else {
+        window.display();
+    }
 }
 
 void draw::drawAll() {
@@ -67,9 +349,9 @@ void draw::close() {
 }
 
 bool draw::isOpen() {
-    return window.isOpen();
+    return offscreenTarget.has_value() || window.isOpen();
 }
 
 std::optional<sf::Event> draw::pollEvent() {
     return window.pollEvent();
-}
\ No newline at end of file
+}
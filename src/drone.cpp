@@ -12,34 +12,55 @@ b2Vec2 rotateVector(const b2Vec2& vec, const b2Rot& rot) {
     };
 }
 
-drone::drone(body* droneBody, std::vector<b2Vec2> motorPositions, std::vector<b2Vec2> motorDirections, float maxThrustPerMotor) {
-    this->droneBody = droneBody;
-    this->motorPositions = motorPositions;
-    this->motorDirections = motorDirections;
+drone::drone() {
+    this->bodyId = b2_nullBodyId;
+    this->motorCount = 0;
+    this->maxThrustPerMotor = 0.0f;
+}
+
+drone::drone(b2BodyId bodyId, std::span<const b2Vec2> motorPositions, std::span<const b2Vec2> motorDirections, float maxThrustPerMotor) {
+    size_t count = std::min(motorPositions.size(), motorDirections.size());
+    if (count > static_cast<size_t>(control::maxMixerMotors)) {
+        std::cerr << "A drone has at most " << control::maxMixerMotors << " motors, got " << count << std::endl;
+        count = control::maxMixerMotors;
+    }
+    this->bodyId = bodyId;
+    this->motorCount = static_cast<int>(count);
+    std::copy_n(motorPositions.begin(), count, this->motorPositions);
+    std::copy_n(motorDirections.begin(), count, this->motorDirections);
     this->maxThrustPerMotor = maxThrustPerMotor;
-    this->lastThrustValues.resize(motorPositions.size(), 0.0f);
+    this->mixer = control::motorMixer(getMotorPositions(), getMotorDirections(), maxThrustPerMotor);
+}
+
+void drone::setLastThrustValues(std::span<const float> thrust) {
+    size_t count = std::min(thrust.size(), static_cast<size_t>(motorCount));
+    std::copy_n(thrust.begin(), count, lastThrustValues);
+    std::fill(lastThrustValues + count, lastThrustValues + motorCount, 0.0f);
 }
 
 float drone::altitude() {
-    b2Vec2 position = b2Body_GetPosition(droneBody->bodyId);
+    b2Vec2 position = b2Body_GetPosition(bodyId);
     return position.y;
 }
 
 float drone::gravitationalForce() {
-    b2MassData mass = b2Body_GetMassData(droneBody->bodyId);
+    b2MassData mass = b2Body_GetMassData(bodyId);
     const float gravity = 9.81f; // m/s^2
     return mass.mass * gravity;
 }
 
 void drone::applyThrust(int motor, b2Vec2 thrustLocation, b2Vec2 thrustVec) {
-    b2Body_ApplyForce(droneBody->bodyId, thrustVec, thrustLocation, true);
+    b2Body_ApplyForce(bodyId, thrustVec, thrustLocation, true);
 }
 
 void drone::applyThrust(int motor, float thrust) {
+    b2Vec2 pos = b2Body_GetPosition(bodyId);
+    b2Rot rot = b2Body_GetRotation(bodyId);
+    applyThrust(motor, thrust, pos, rot);
+}
+
+void drone::applyThrust(int motor, float thrust, b2Vec2 pos, b2Rot rot) {
     thrust = std::clamp(thrust, 0.0f, maxThrustPerMotor);
-    
-    b2Vec2 pos = b2Body_GetPosition(droneBody->bodyId);
-    b2Rot rot = b2Body_GetRotation(droneBody->bodyId);
 
     b2Vec2 thrustLocation = pos + rotateVector(motorPositions[motor], rot);
     b2Vec2 thrustDirection = rotateVector(motorDirections[motor], rot);
@@ -51,8 +72,25 @@ void drone::applyThrust(int motor, float thrust) {
 }
 
 void drone::applyThrustEvenly(float thrust) {
-    size_t n_motors = motorPositions.size();
-    for (size_t i = 0; i < n_motors; ++i) {
-        applyThrust(i, thrust / n_motors);
+    // The transform doesn't change between motors, so query it once
+    b2Vec2 pos = b2Body_GetPosition(bodyId);
+    b2Rot rot = b2Body_GetRotation(bodyId);
+    int n_motors = motorCount;
+    for (int i = 0; i < n_motors; ++i) {
+        applyThrust(i, thrust / n_motors, pos, rot);
+    }
+}
+
+void drone::applyWrench(float collective, float torque) {
+    if (!mixer.isValid()) {
+        applyThrustEvenly(collective);
+        return;
+    }
+    float thrust[control::maxMixerMotors];
+    mixer.mix(collective, torque, thrust);
+    b2Vec2 pos = b2Body_GetPosition(bodyId);
+    b2Rot rot = b2Body_GetRotation(bodyId);
+    for (int i = 0; i < mixer.getMotorCount(); ++i) {
+        applyThrust(i, thrust[i], pos, rot);
     }
-}
\ No newline at end of file
+}
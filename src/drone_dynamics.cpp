@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <cmath>
+#include "../include/drone_dynamics.hpp"
+
+droneModel makeDroneModel(drone& d, float gravity) {
+    b2MassData mass = b2Body_GetMassData(d.getBodyId());
+    droneModel model;
+    model.mass = mass.mass;
+    model.inertia = mass.rotationalInertia;
+    model.gravity = gravity;
+    model.maxThrustPerMotor = d.getMaxThrustPerMotor();
+    model.motorCount = std::min(static_cast<int>(d.getMotorPositions().size()), control::maxMixerMotors);
+    for (int i = 0; i < model.motorCount; ++i) {
+        b2Vec2 position = d.getMotorPositions()[i];
+        b2Vec2 direction = d.getMotorDirections()[i];
+        model.directionX[i] = direction.x;
+        model.directionY[i] = direction.y;
+        model.torqueArm[i] = position.x * direction.y - position.y * direction.x;
+    }
+    return model;
+}
+
+droneDynamics::droneDynamics(const droneModel& model, int subStepCount) {
+    this->model = model;
+    this->subStepCount = std::max(subStepCount, 1);
+    this->wind = nullptr;
+}
+
+void droneDynamics::reserve(size_t count) {
+    for (std::vector<float>* column : { &posX, &posY, &rotC, &rotS, &velX, &velY, &angularVelocity,
+                                        &accelX, &accelY, &angularAccel }) {
+        column->reserve(count);
+    }
+    for (int m = 0; m < model.motorCount; ++m) {
+        thrust[m].reserve(count);
+    }
+}
+
+size_t droneDynamics::addDrone(const rigidBodyState& state) {
+    posX.push_back(state.position.x);
+    posY.push_back(state.position.y);
+    rotC.push_back(state.rotation.c);
+    rotS.push_back(state.rotation.s);
+    velX.push_back(state.linearVelocity.x);
+    velY.push_back(state.linearVelocity.y);
+    angularVelocity.push_back(state.angularVelocity);
+    for (int m = 0; m < model.motorCount; ++m) {
+        thrust[m].push_back(0.0f);
+    }
+    accelX.push_back(0.0f);
+    accelY.push_back(0.0f);
+    angularAccel.push_back(0.0f);
+    return posX.size() - 1;
+}
+
+void droneDynamics::setThrust(size_t index, int motor, float value) {
+    thrust[motor][index] = std::clamp(value, 0.0f, model.maxThrustPerMotor);
+}
+
+void droneDynamics::setThrustEvenly(size_t index, float total) {
+    float each = model.motorCount > 0 ? total / model.motorCount : 0.0f;
+    for (int m = 0; m < model.motorCount; ++m) {
+        setThrust(index, m, each);
+    }
+}
+
+void droneDynamics::step(float timeStep) {
+    if (wind) {
+        stepInWind(timeStep);
+        return;
+    }
+    const size_t n = posX.size();
+    const float invMass = 1.0f / model.mass;
+    const float invInertia = 1.0f / model.inertia;
+    const float h = timeStep / subStepCount;
+
+    // Body-frame force and torque, accumulated motor by motor
+    std::fill(accelX.begin(), accelX.end(), 0.0f);
+    std::fill(accelY.begin(), accelY.end(), 0.0f);
+    std::fill(angularAccel.begin(), angularAccel.end(), 0.0f);
+    float* ax = accelX.data();
+    float* ay = accelY.data();
+    float* alpha = angularAccel.data();
+    for (int m = 0; m < model.motorCount; ++m) {
+        const float* u = thrust[m].data();
+        const float dx = model.directionX[m];
+        const float dy = model.directionY[m];
+        const float arm = model.torqueArm[m];
+        for (size_t i = 0; i < n; ++i) {
+            ax[i] += dx * u[i];
+            ay[i] += dy * u[i];
+            alpha[i] += arm * u[i];
+        }
+    }
+
+    float* px = posX.data();
+    float* py = posY.data();
+    float* c = rotC.data();
+    float* s = rotS.data();
+    float* vx = velX.data();
+    float* vy = velY.data();
+    float* w = angularVelocity.data();
+    for (size_t i = 0; i < n; ++i) {
+        // Into the world frame at the start-of-step rotation, as b2Body_ApplyForce does
+        float fx = c[i] * ax[i] - s[i] * ay[i];
+        float fy = s[i] * ax[i] + c[i] * ay[i];
+        float accelerationX = fx * invMass;
+        float accelerationY = fy * invMass - model.gravity;
+        float angularAcceleration = alpha[i] * invInertia;
+        for (int sub = 0; sub < subStepCount; ++sub) {
+            vx[i] += h * accelerationX;
+            vy[i] += h * accelerationY;
+            w[i] += h * angularAcceleration;
+            px[i] += h * vx[i];
+            py[i] += h * vy[i];
+            float q2c = c[i] - h * w[i] * s[i];
+            float q2s = s[i] + h * w[i] * c[i];
+            float invLength = 1.0f / std::sqrt(q2c * q2c + q2s * q2s);
+            c[i] = q2c * invLength;
+            s[i] = q2s * invLength;
+        }
+    }
+}
+
+// Same integration with drones advanced together one substep at a time, so the
+// wind loads follow every substep instead of being held for the whole step
+void droneDynamics::stepInWind(float timeStep) {
+    const size_t n = posX.size();
+    const float invMass = 1.0f / model.mass;
+    const float invInertia = 1.0f / model.inertia;
+    const float h = timeStep / subStepCount;
+
+    bodyThrust.assign(n, 0.0f);
+    std::fill(accelX.begin(), accelX.end(), 0.0f);
+    std::fill(angularAccel.begin(), angularAccel.end(), 0.0f);
+    float* ax = accelX.data();
+    float* ay = bodyThrust.data();
+    float* alpha = angularAccel.data();
+    for (int m = 0; m < model.motorCount; ++m) {
+        const float* u = thrust[m].data();
+        const float dx = model.directionX[m];
+        const float dy = model.directionY[m];
+        const float arm = model.torqueArm[m];
+        for (size_t i = 0; i < n; ++i) {
+            ax[i] += dx * u[i];
+            ay[i] += dy * u[i];
+            alpha[i] += arm * u[i];
+        }
+    }
+
+    float* px = posX.data();
+    float* py = posY.data();
+    float* c = rotC.data();
+    float* s = rotS.data();
+    float* vx = velX.data();
+    float* vy = velY.data();
+    float* w = angularVelocity.data();
+    // Thrust into the world frame at the start-of-step rotation, as in step()
+    float* thrustX = accelX.data();
+    float* thrustY = accelY.data();
+    for (size_t i = 0; i < n; ++i) {
+        float bodyX = ax[i];
+        thrustX[i] = c[i] * bodyX - s[i] * ay[i];
+        thrustY[i] = s[i] * bodyX + c[i] * ay[i];
+    }
+
+    windForceX.resize(n);
+    windForceY.resize(n);
+    windTorque.resize(n);
+    windBodies state;
+    state.count = n;
+    state.posX = px;
+    state.posY = py;
+    state.rotC = c;
+    state.rotS = s;
+    state.velX = vx;
+    state.velY = vy;
+    state.thrust = bodyThrust.data();
+    const windLoads loads = { windForceX.data(), windForceY.data(), windTorque.data() };
+    for (int sub = 0; sub < subStepCount; ++sub) {
+        computeWindLoads(*wind, windDrag, state, loads);
+        for (size_t i = 0; i < n; ++i) {
+            vx[i] += h * (thrustX[i] + windForceX[i]) * invMass;
+            vy[i] += h * ((thrustY[i] + windForceY[i]) * invMass - model.gravity);
+            w[i] += h * (alpha[i] + windTorque[i]) * invInertia;
+            px[i] += h * vx[i];
+            py[i] += h * vy[i];
+            float q2c = c[i] - h * w[i] * s[i];
+            float q2s = s[i] + h * w[i] * c[i];
+            float invLength = 1.0f / std::sqrt(q2c * q2c + q2s * q2s);
+            c[i] = q2c * invLength;
+            s[i] = q2s * invLength;
+        }
+    }
+}
+
+rigidBodyState droneDynamics::getState(size_t index) const {
+    return { { posX[index], posY[index] }, { rotC[index], rotS[index] },
+             { velX[index], velY[index] }, angularVelocity[index] };
+}
@@ -0,0 +1,46 @@
+#include <algorithm>
+#include <cmath>
+#include "../include/dynamics_validation.hpp"
+
+dynamicsValidation validateDynamics(const simulationConfig& config, int steps, float positionTolerance) {
+    simulation sim(config);
+    sim.setControllerEnabled(false);
+    b2BodyId bodyId = sim.getDroneBody().bodyId;
+    b2Body_SetTransform(bodyId, { config.worldWidth / 2.0f, 5000.0f }, b2MakeRot(0.0f));
+
+    drone& d = sim.getDrone();
+    droneModel model = makeDroneModel(d);
+    droneDynamics fast(model, config.subStepCount);
+    fast.addDrone({ b2Body_GetPosition(bodyId), b2Body_GetRotation(bodyId),
+                    b2Body_GetLinearVelocity(bodyId), b2Body_GetAngularVelocity(bodyId) });
+
+    float hover = fast.weight() / std::max(model.motorCount, 1);
+    dynamicsValidation report = { 0, 0.0f, 0.0f, 0.0f, 0.0f, -1 };
+    for (int step = 0; step < steps; ++step) {
+        float t = step * config.timeStep;
+        for (int m = 0; m < model.motorCount; ++m) {
+            float thrust = hover * (1.0f + 0.05f * std::sin(0.7f * t * (m + 1) + m));
+            d.applyThrust(m, thrust);
+            fast.setThrust(0, m, thrust);
+        }
+        sim.step();
+        fast.step(config.timeStep);
+
+        rigidBodyState expected = fast.getState(0);
+        b2Vec2 position = b2Body_GetPosition(bodyId);
+        b2Vec2 velocity = b2Body_GetLinearVelocity(bodyId);
+        float positionError = b2Length(position - expected.position);
+        float velocityError = b2Length(velocity - expected.linearVelocity);
+        float angleError = std::abs(b2RelativeAngle(b2Body_GetRotation(bodyId), expected.rotation));
+
+        report.steps = step + 1;
+        report.maxPositionError = std::max(report.maxPositionError, positionError);
+        report.finalPositionError = positionError;
+        report.maxAngleError = std::max(report.maxAngleError, angleError);
+        report.maxVelocityError = std::max(report.maxVelocityError, velocityError);
+        if (report.firstStepOverTolerance < 0 && positionError > positionTolerance) {
+            report.firstStepOverTolerance = step;
+        }
+    }
+    return report;
+}
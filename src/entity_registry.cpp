@@ -0,0 +1,107 @@
+#include <box2d/box2d.h>
+#include <cstdint>
+#include "../include/entity_registry.hpp"
+
+// Box2D user data holds slot + 1 so a null pointer still means "not ours"
+static void* slotToUserData(uint32_t slot) {
+    return reinterpret_cast<void*>(static_cast<uintptr_t>(slot) + 1);
+}
+
+entityRegistry::entityRegistry(b2WorldId worldId, size_t capacity) {
+    this->worldId = worldId;
+    reserve(capacity);
+}
+
+entityRegistry::~entityRegistry() {
+    clear();
+}
+
+void entityRegistry::reserve(size_t capacity) {
+    entities.reserve(capacity);
+    drones.reserve(capacity);
+}
+
+entityHandle entityRegistry::adopt(const body& shape, uint32_t color) {
+    entityHandle handle = entities.insert({ shape, color, {} });
+    b2Body_SetUserData(shape.bodyId, slotToUserData(handle.index));
+    return handle;
+}
+
+entityHandle entityRegistry::spawnBox(b2Vec2 position, float height, float width, b2BodyType type, bool collide, float density, uint32_t color) {
+    return adopt(body(worldId, position, height, width, type, collide, density), color);
+}
+
+entityHandle entityRegistry::spawnDrone(b2Vec2 position, float height, float width, float density, std::span<const b2Vec2> motorPositions,
+                                        std::span<const b2Vec2> motorDirections, float maxThrustPerMotor, uint32_t color) {
+    body airframe(worldId, position, height, width, b2_dynamicBody, true, density);
+    entityHandle handle = adopt(airframe, color);
+    entities.get(handle)->drone = drones.insert(drone(airframe.bodyId, motorPositions, motorDirections, maxThrustPerMotor));
+    return handle;
+}
+
+bool entityRegistry::destroy(entityHandle handle) {
+    entityRecord* record = entities.get(handle);
+    if (!record) {
+        return false;
+    }
+    drones.erase(record->drone);
+    if (b2Body_IsValid(record->shape.bodyId)) {
+        b2DestroyBody(record->shape.bodyId);
+    }
+    entities.erase(handle);
+    return true;
+}
+
+void entityRegistry::clear() {
+    if (b2World_IsValid(worldId)) {
+        for (size_t i = 0; i < entities.size(); ++i) {
+            if (b2Body_IsValid(entities[i].shape.bodyId)) {
+                b2DestroyBody(entities[i].shape.bodyId);
+            }
+        }
+    }
+    entities.clear();
+    drones.clear();
+}
+
+body* entityRegistry::getBody(entityHandle handle) {
+    entityRecord* record = entities.get(handle);
+    return record ? &record->shape : nullptr;
+}
+
+const body* entityRegistry::getBody(entityHandle handle) const {
+    const entityRecord* record = entities.get(handle);
+    return record ? &record->shape : nullptr;
+}
+
+drone* entityRegistry::getDrone(entityHandle handle) {
+    const entityRecord* record = entities.get(handle);
+    return record ? drones.get(record->drone) : nullptr;
+}
+
+uint32_t entityRegistry::getColor(entityHandle handle) const {
+    const entityRecord* record = entities.get(handle);
+    return record ? record->color : 0;
+}
+
+bool entityRegistry::setColor(entityHandle handle, uint32_t color) {
+    entityRecord* record = entities.get(handle);
+    if (!record) {
+        return false;
+    }
+    record->color = color;
+    return true;
+}
+
+entityHandle entityRegistry::handleOf(b2BodyId bodyId) const {
+    uintptr_t tag = reinterpret_cast<uintptr_t>(b2Body_GetUserData(bodyId));
+    if (tag == 0) {
+        return {};
+    }
+    entityHandle handle = entities.handleOfSlot(static_cast<uint32_t>(tag - 1));
+    const entityRecord* record = entities.get(handle);
+    if (!record || !B2_ID_EQUALS(record->shape.bodyId, bodyId)) {
+        return {};
+    }
+    return handle;
+}
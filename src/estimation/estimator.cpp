@@ -0,0 +1,99 @@
+#include <cmath>
+#include "../../include/estimation/estimator.hpp"
+
+using namespace estimation;
+
+stateEstimator::stateEstimator(const estimatorConfig& config) {
+    this->config = config;
+    this->covariance = matrix<3, 3>::identity();
+    this->x = 0.0f;
+    this->velX = 0.0f;
+    this->angle = 0.0f;
+    this->angularVelocity = 0.0f;
+    this->gyroBias = 0.0f;
+}
+
+void stateEstimator::reset(b2BodyId bodyId) {
+    b2Transform transform = b2Body_GetTransform(bodyId);
+    b2Vec2 velocity = b2Body_GetLinearVelocity(bodyId);
+    vertical = vec<3>();
+    vertical[0] = transform.p.y;
+    vertical[1] = velocity.y;
+    covariance = matrix<3, 3>::identity();
+    covariance(0, 0) = config.baroNoise * config.baroNoise;
+    covariance(2, 2) = config.accelNoise * config.accelNoise;
+    x = transform.p.x;
+    velX = velocity.x;
+    angle = b2Rot_GetAngle(transform.q);
+    angularVelocity = b2Body_GetAngularVelocity(bodyId);
+    gyroBias = 0.0f;
+}
+
+void stateEstimator::predict(const imuSample& sample, float dt) {
+    // Attitude
+    angularVelocity = sample.gyro - gyroBias;
+    angle += angularVelocity * dt;
+    float forceSquared = sample.accelX * sample.accelX + sample.accelY * sample.accelY;
+    float g2 = config.gravity * config.gravity;
+    if (forceSquared > 0.81f * g2 && forceSquared < 1.21f * g2) {
+        float residual = std::atan2(sample.accelX, sample.accelY) - angle;
+        residual = std::atan2(std::sin(residual), std::cos(residual));
+        angle += config.tiltGain * dt * residual;
+        gyroBias -= config.gyroBiasGain * dt * residual;
+    }
+
+    // Specific force back into the world frame, plus gravity
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+    float accelX = c * sample.accelX - s * sample.accelY;
+    float accelY = s * sample.accelX + c * sample.accelY - config.gravity;
+
+    x += velX * dt + 0.5f * accelX * dt * dt;
+    velX += accelX * dt;
+
+    // Vertical Kalman prediction: the accelerometer is the control input, its bias a state
+    float halfDt2 = 0.5f * dt * dt;
+    matrix<3, 3> transition = matrix<3, 3>::identity();
+    transition(0, 1) = dt;
+    transition(0, 2) = -halfDt2;
+    transition(1, 2) = -dt;
+    vec<3> input;
+    input[0] = halfDt2;
+    input[1] = dt;
+    vertical = transition * vertical + input * accelY;
+
+    float accelVariance = config.accelNoise * config.accelNoise;
+    matrix<3, 3> processNoise = (input * input.transposed()) * accelVariance;
+    processNoise(2, 2) += config.accelBiasWalk * config.accelBiasWalk * dt;
+    covariance = transition * covariance * transition.transposed() + processNoise;
+}
+
+void stateEstimator::correctAltitude(float measuredAltitude) {
+    // H = [1 0 0], so the innovation covariance is a scalar
+    float innovation = measuredAltitude - vertical[0];
+    float innovationVariance = covariance(0, 0) + config.baroNoise * config.baroNoise;
+    vec<3> gain;
+    for (size_t i = 0; i < 3; ++i) {
+        gain[i] = covariance(i, 0) / innovationVariance;
+    }
+    vertical += gain * innovation;
+
+    // P = (I - K H) P, where H P is the first row of P
+    matrix<1, 3> firstRow;
+    for (size_t i = 0; i < 3; ++i) {
+        firstRow[i] = covariance(0, i);
+    }
+    covariance -= gain * firstRow;
+}
+
+control::measurement stateEstimator::estimate(float weight) const {
+    control::measurement m;
+    m.x = x;
+    m.y = vertical[0];
+    m.angle = angle;
+    m.velX = velX;
+    m.velY = vertical[1];
+    m.angularVelocity = angularVelocity;
+    m.weight = weight;
+    return m;
+}
@@ -0,0 +1,84 @@
+#include <cmath>
+#include "../../include/estimation/sensors.hpp"
+
+using namespace estimation;
+
+noiseSource::noiseSource(uint64_t seed) {
+    this->state = seed ? seed : 1;
+    this->spare = 0.0f;
+    this->hasSpare = false;
+}
+
+float noiseSource::uniform() {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    uint64_t bits = state * 0x2545F4914F6CDD1Dull;
+    return (static_cast<float>(bits >> 40) + 1.0f) * (1.0f / 16777216.0f);
+}
+
+float noiseSource::gaussian() {
+    if (hasSpare) {
+        hasSpare = false;
+        return spare;
+    }
+    float radius = std::sqrt(-2.0f * std::log(uniform()));
+    float theta = 6.2831853f * uniform();
+    spare = radius * std::sin(theta);
+    hasSpare = true;
+    return radius * std::cos(theta);
+}
+
+static float walkBias(float bias, const noiseModel& model, noiseSource& rng, float dt) {
+    return model.biasWalk > 0.0f ? bias + model.biasWalk * std::sqrt(dt) * rng.gaussian() : bias;
+}
+
+imu::imu(const noiseModel& accel, const noiseModel& gyro, uint64_t seed) : rng(seed) {
+    this->accel = accel;
+    this->gyro = gyro;
+    this->accelBias = { accel.bias, accel.bias };
+    this->gyroBias = gyro.bias;
+    this->previousVelocity = { 0.0f, 0.0f };
+    this->primed = false;
+}
+
+imuSample imu::sample(b2BodyId bodyId, float dt) {
+    b2Vec2 velocity = b2Body_GetLinearVelocity(bodyId);
+    b2Rot rotation = b2Body_GetRotation(bodyId);
+    b2Vec2 acceleration = { 0.0f, 0.0f };
+    if (primed && dt > 0.0f) {
+        acceleration = { (velocity.x - previousVelocity.x) / dt, (velocity.y - previousVelocity.y) / dt };
+    }
+    previousVelocity = velocity;
+    primed = true;
+
+    b2Vec2 gravity = b2World_GetGravity(b2Body_GetWorld(bodyId));
+    b2Vec2 specificForce = b2InvRotateVector(rotation, { acceleration.x - gravity.x, acceleration.y - gravity.y });
+
+    accelBias.x = walkBias(accelBias.x, accel, rng, dt);
+    accelBias.y = walkBias(accelBias.y, accel, rng, dt);
+    gyroBias = walkBias(gyroBias, gyro, rng, dt);
+
+    b2Vec2 measuredAccel;
+    measuredAccel.x = specificForce.x + accelBias.x + accel.stdDev * rng.gaussian();
+    measuredAccel.y = specificForce.y + accelBias.y + accel.stdDev * rng.gaussian();
+    float measuredGyro = b2Body_GetAngularVelocity(bodyId) + gyroBias + gyro.stdDev * rng.gaussian();
+
+    imuSample delivered;
+    b2Vec2 delayedAccel = accelDelay.push(measuredAccel, accel.latencySteps);
+    delivered.accelX = delayedAccel.x;
+    delivered.accelY = delayedAccel.y;
+    delivered.gyro = gyroDelay.push(measuredGyro, gyro.latencySteps);
+    return delivered;
+}
+
+barometer::barometer(const noiseModel& altitude, uint64_t seed) : rng(seed) {
+    this->altitude = altitude;
+    this->bias = altitude.bias;
+}
+
+float barometer::sample(b2BodyId bodyId, float dt) {
+    bias = walkBias(bias, altitude, rng, dt);
+    float measured = b2Body_GetPosition(bodyId).y + bias + altitude.stdDev * rng.gaussian();
+    return delay.push(measured, altitude.latencySteps);
+}
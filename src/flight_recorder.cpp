@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include "../include/flight_recorder.hpp"
+
+static const char recordMagic[8] = { 'D', 'C', 'F', 'L', 'I', 'G', 'H', 'T' };
+static const uint32_t recordVersion = 1;
+
+flightRecorder::flightRecorder() : header(nullptr), records(nullptr) {
+}
+
+bool flightRecorder::open(const std::string& path, uint64_t capacity, float timeStep) {
+    close();
+    if (capacity == 0 || !file.create(path, sizeof(flightRecordHeader) + capacity * sizeof(flightRecord))) {
+        return false;
+    }
+    header = static_cast<flightRecordHeader*>(file.getData());
+    records = reinterpret_cast<flightRecord*>(header + 1);
+    std::memset(header, 0, sizeof(flightRecordHeader));
+    std::memcpy(header->magic, recordMagic, sizeof(recordMagic));
+    header->version = recordVersion;
+    header->recordSize = sizeof(flightRecord);
+    header->capacity = capacity;
+    header->written = 0;
+    header->timeStep = timeStep;
+    return true;
+}
+
+void flightRecorder::close() {
+    file.close();
+    header = nullptr;
+    records = nullptr;
+}
+
+void flightRecorder::record(const flightRecord& r) {
+    records[header->written % header->capacity] = r;
+    ++header->written;
+}
+
+void flightRecorder::record(uint64_t step, simulation& sim) {
+    if (!header) {
+        return;
+    }
+    flightRecord r;
+    b2BodyId bodyId = sim.getDroneBody().bodyId;
+    b2Transform transform = b2Body_GetTransform(bodyId);
+    b2Vec2 velocity = b2Body_GetLinearVelocity(bodyId);
+    // The hover PID keeps its last terms while it isn't running; log zeros then
+    bool hoverActive = sim.isControllerEnabled() && sim.getControllerKind() == controllerKind::hover;
+    pid::terms terms = hoverActive ? sim.getController().getLastTerms() : pid::terms{ 0.0f, 0.0f, 0.0f };
+    std::span<const float> thrust = sim.getDrone().getLastThrustValues();
+
+    r.step = step;
+    r.time = step * static_cast<double>(sim.getConfig().timeStep);
+    r.posX = transform.p.x;
+    r.posY = transform.p.y;
+    r.angle = b2Rot_GetAngle(transform.q);
+    r.velX = velocity.x;
+    r.velY = velocity.y;
+    r.angularVelocity = b2Body_GetAngularVelocity(bodyId);
+    r.targetAltitude = sim.getTargetAltitude();
+    r.p = terms.p;
+    r.i = terms.i;
+    r.d = terms.d;
+    r.motorCount = static_cast<uint32_t>(std::min<size_t>(thrust.size(), control::maxMixerMotors));
+    for (int m = 0; m < control::maxMixerMotors; ++m) {
+        r.thrust[m] = m < static_cast<int>(r.motorCount) ? thrust[m] : 0.0f;
+    }
+    record(r);
+}
+
+flightLog::flightLog() : header(nullptr), records(nullptr), count(0), first(0) {
+}
+
+bool flightLog::open(const std::string& path) {
+    header = nullptr;
+    if (!file.openReadOnly(path) || file.getSize() < sizeof(flightRecordHeader)) {
+        return false;
+    }
+    const flightRecordHeader* h = static_cast<const flightRecordHeader*>(file.getData());
+    if (std::memcmp(h->magic, recordMagic, sizeof(recordMagic)) != 0 || h->version != recordVersion
+        || h->recordSize != sizeof(flightRecord) || h->capacity == 0
+        || file.getSize() < sizeof(flightRecordHeader) + h->capacity * sizeof(flightRecord)) {
+        file.close();
+        return false;
+    }
+    header = h;
+    records = reinterpret_cast<const flightRecord*>(h + 1);
+    count = static_cast<size_t>(std::min(h->written, h->capacity));
+    first = h->written > h->capacity ? static_cast<size_t>(h->written % h->capacity) : 0;
+    return true;
+}
+
+// Formats straight into a reusable buffer with std::to_chars and writes in large chunks
+bool flightLog::exportCsv(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        return false;
+    }
+    uint32_t motors = getMotorCount();
+    out << "step,time,pos_x,pos_y,angle,vel_x,vel_y,angular_velocity,target_altitude,p,i,d";
+    for (uint32_t m = 0; m < motors; ++m) {
+        out << ",thrust_" << m;
+    }
+    out << "\n";
+
+    std::vector<char> buffer(1 << 20);
+    size_t used = 0;
+    auto flush = [&]() {
+        out.write(buffer.data(), static_cast<std::streamsize>(used));
+        used = 0;
+    };
+    auto put = [&](auto value, bool comma) {
+        auto result = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value);
+        used = static_cast<size_t>(result.ptr - buffer.data());
+        buffer[used++] = comma ? ',' : '\n';
+    };
+
+    for (size_t row = 0; row < count; ++row) {
+        if (buffer.size() - used < 1024) {
+            flush();
+        }
+        const flightRecord& r = at(row);
+        put(r.step, true);
+        put(r.time, true);
+        for (float value : { r.posX, r.posY, r.angle, r.velX, r.velY, r.angularVelocity, r.targetAltitude, r.p, r.i }) {
+            put(value, true);
+        }
+        put(r.d, motors > 0);
+        for (uint32_t m = 0; m < motors; ++m) {
+            put(r.thrust[m], m + 1 < motors);
+        }
+    }
+    flush();
+    return static_cast<bool>(out);
+}
+
+bool flightLog::exportColumns(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        return false;
+    }
+
+    enum : uint8_t { f32 = 0, f64 = 1, u64 = 2 };
+    struct column {
+        std::string name;
+        uint8_t type;
+    };
+    std::vector<column> columns = {
+        { "step", u64 }, { "time", f64 },
+        { "pos_x", f32 }, { "pos_y", f32 }, { "angle", f32 },
+        { "vel_x", f32 }, { "vel_y", f32 }, { "angular_velocity", f32 },
+        { "target_altitude", f32 }, { "p", f32 }, { "i", f32 }, { "d", f32 },
+    };
+    uint32_t motors = getMotorCount();
+    for (uint32_t m = 0; m < motors; ++m) {
+        columns.push_back({ "thrust_" + std::to_string(m), f32 });
+    }
+
+    out.write("DCCOLS01", 8);
+    uint32_t columnCount = static_cast<uint32_t>(columns.size());
+    uint64_t rowCount = count;
+    out.write(reinterpret_cast<const char*>(&columnCount), sizeof(columnCount));
+    out.write(reinterpret_cast<const char*>(&rowCount), sizeof(rowCount));
+    for (const column& c : columns) {
+        uint16_t nameLength = static_cast<uint16_t>(c.name.size());
+        out.write(reinterpret_cast<const char*>(&c.type), sizeof(c.type));
+        out.write(reinterpret_cast<const char*>(&nameLength), sizeof(nameLength));
+        out.write(c.name.data(), nameLength);
+    }
+
+    // Gather one field at a time into a contiguous array, then write it in one go
+    std::vector<char> data;
+    auto writeColumn = [&](size_t elementSize, auto extract) {
+        data.resize(count * elementSize);
+        for (size_t row = 0; row < count; ++row) {
+            auto value = extract(at(row));
+            std::memcpy(data.data() + row * elementSize, &value, elementSize);
+        }
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    };
+    writeColumn(sizeof(uint64_t), [](const flightRecord& r) { return r.step; });
+    writeColumn(sizeof(double), [](const flightRecord& r) { return r.time; });
+    writeColumn(sizeof(float), [](const flightRecord& r) { return r.posX; });
+    writeColumn(sizeof(float), [](const flightRecord& r) { return r.posY; });
+    writeColumn(sizeof(float), [](const flightRecord& r) { return r.angle; });
+    writeColumn(sizeof(float), [](const flightRecord& r) { return r.velX; });
+    writeColumn(sizeof(float), [](const flightRecord& r) { return r.velY; });
+    writeColumn(sizeof(float), [](const flightRecord& r) { return r.angularVelocity; });
+    writeColumn(sizeof(float), [](const flightRecord& r) { return r.targetAltitude; });
+    writeColumn(sizeof(float), [](const flightRecord& r) { return r.p; });
+    writeColumn(sizeof(float), [](const flightRecord& r) { return r.i; });
+    writeColumn(sizeof(float), [](const flightRecord& r) { return r.d; });
+    for (uint32_t m = 0; m < motors; ++m) {
+        writeColumn(sizeof(float), [m](const flightRecord& r) { return r.thrust[m]; });
+    }
+    return static_cast<bool>(out);
+}
@@ -1,6 +1,6 @@
 #include "../include/force_arrows.hpp"
+#include <algorithm>
 #include <cmath>
-#include <functional>
 
 static b2Vec2 rotateVector(const b2Vec2& vec, const b2Rot& rot) {
     return {
@@ -11,9 +11,11 @@ static b2Vec2 rotateVector(const b2Vec2& vec, const b2Rot& rot) {
 
 ForceArrowDrawer::ForceArrowDrawer(float scaleFactor, float arrowHeadSize)
     : scaleFactor(scaleFactor), arrowHeadSize(arrowHeadSize) {
+    batch.setPrimitiveType(sf::PrimitiveType::Triangles);
 }
 
-void ForceArrowDrawer::drawArrow(sf::RenderWindow& window, sf::Vector2f start, sf::Vector2f end, sf::Color color) {
+// Shaft as a two-triangle quad plus a triangular head: 9 vertices per arrow
+void ForceArrowDrawer::addArrow(sf::Vector2f start, sf::Vector2f end, sf::Color color) {
     sf::Vector2f dir = end - start;
     float len = std::sqrt(dir.x * dir.x + dir.y * dir.y);
     if (len < 5.0f) return;
@@ -21,73 +23,111 @@ void ForceArrowDrawer::drawArrow(sf::RenderWindow& window, sf::Vector2f start, s
     dir /= len;
     sf::Vector2f perp = { -dir.y, dir.x };
     
-    float lineThickness = 2.0f;
-    sf::RectangleShape line(sf::Vector2f(len - arrowHeadSize, lineThickness));
-    line.setFillColor(color);
-    line.setOrigin(sf::Vector2f(0.f, lineThickness / 2.f));
-    line.setPosition(start);
-    line.setRotation(sf::radians(std::atan2(dir.y, dir.x)));
-    window.draw(line);
-    
-    sf::ConvexShape head(3);
+    float halfThickness = 1.0f;
     sf::Vector2f base = end - dir * arrowHeadSize;
-    head.setPoint(0, end);
-    head.setPoint(1, base + perp * (arrowHeadSize * 0.5f));
-    head.setPoint(2, base - perp * (arrowHeadSize * 0.5f));
-    head.setFillColor(color);
-    window.draw(head);
+    sf::Vector2f side = perp * halfThickness;
+    batch.append(sf::Vertex{start + side, color});
+    batch.append(sf::Vertex{start - side, color});
+    batch.append(sf::Vertex{base + side, color});
+    batch.append(sf::Vertex{base + side, color});
+    batch.append(sf::Vertex{start - side, color});
+    batch.append(sf::Vertex{base - side, color});
+    
+    batch.append(sf::Vertex{end, color});
+    batch.append(sf::Vertex{base + perp * (arrowHeadSize * 0.5f), color});
+    batch.append(sf::Vertex{base - perp * (arrowHeadSize * 0.5f), color});
 }
 
-void ForceArrowDrawer::addNetForce(sf::RenderWindow& window,
-                                    std::function<sf::Vector2f(float, float)> toWindowLocation,
-                                    drone& d, body& droneBody,
-                                    sf::Color sumColor,
-                                    sf::Color vertColor,
-                                    sf::Color horizColor) {
-    b2Vec2 pos = b2Body_GetPosition(droneBody.bodyId);
-    b2Rot rot = b2Body_GetRotation(droneBody.bodyId);
-    
-    // Gravity
-    float gravity = d.gravitationalForce();
-    b2Vec2 netForce = { 0.0f, -gravity };
-    
-    // Sum all thrusts
-    const auto& thrustValues = d.getLastThrustValues();
-    const auto& motorPositions = d.getMotorPositions();
-    const auto& motorDirections = d.getMotorDirections();
-    
-    for (size_t i = 0; i < thrustValues.size() && i < motorDirections.size(); ++i) {
-        b2Vec2 thrustDir = rotateVector(motorDirections[i], rot);
-        netForce.x += thrustDir.x * thrustValues[i];
-        netForce.y += thrustDir.y * thrustValues[i];
-    }
+void ForceArrowDrawer::addNetForce(b2Vec2 pos, b2Vec2 netForce, const viewTransform& view,
+                                    sf::Color sumColor, sf::Color vertColor, sf::Color horizColor) {
+    sf::Vector2f startPos = view.apply(pos.x, pos.y);
     
-    sf::Vector2f startPos = toWindowLocation(pos.x, pos.y);
-    
-    // Vertical component (green)
+    // Vertical component
     if (std::abs(netForce.y) > 0.1f) {
         float vertLen = std::clamp(std::abs(netForce.y) * scaleFactor, 10.0f, 150.0f);
         float endY = pos.y + (netForce.y > 0 ? vertLen : -vertLen);
-        sf::Vector2f vertEnd = toWindowLocation(pos.x, endY);
-        drawArrow(window, startPos, vertEnd, vertColor);
+        addArrow(startPos, view.apply(pos.x, endY), vertColor);
     }
     
-    // Horizontal component (red)
+    // Horizontal component
     if (std::abs(netForce.x) > 0.1f) {
         float horizLen = std::clamp(std::abs(netForce.x) * scaleFactor, 10.0f, 150.0f);
         float endX = pos.x + (netForce.x > 0 ? horizLen : -horizLen);
-        sf::Vector2f horizEnd = toWindowLocation(endX, pos.y);
-        drawArrow(window, startPos, horizEnd, horizColor);
+        addArrow(startPos, view.apply(endX, pos.y), horizColor);
     }
     
-    // Net force (white)
+    // Net force
     float mag = std::sqrt(netForce.x * netForce.x + netForce.y * netForce.y);
     if (mag > 0.1f) {
         float arrowLen = std::clamp(mag * scaleFactor, 10.0f, 150.0f);
         b2Vec2 dir = { netForce.x / mag, netForce.y / mag };
-        float endX = pos.x + dir.x * arrowLen;
-        float endY = pos.y + dir.y * arrowLen;
-        sf::Vector2f netEnd = toWindowLocation(endX, endY);
-        drawArrow(window, startPos, netEnd, sumColor);
+        addArrow(startPos, view.apply(pos.x + dir.x * arrowLen, pos.y + dir.y * arrowLen), sumColor);
+    }
+}
+
+void ForceArrowDrawer::addNetForce(const droneSnapshot& d, const viewTransform& view,
+                                    sf::Color sumColor, sf::Color vertColor, sf::Color horizColor) {
+    addNetForces(std::span<const droneSnapshot>(&d, 1), view, sumColor, vertColor, horizColor);
+}
+
+void ForceArrowDrawer::addNetForces(std::span<const droneSnapshot> drones, const viewTransform& view,
+                                     sf::Color sumColor, sf::Color vertColor, sf::Color horizColor) {
+    for (const droneSnapshot& d : drones) {
+        // Gravity plus the sum of all thrusts
+        b2Vec2 netForce = { 0.0f, -d.weight };
+        for (size_t i = 0; i < d.thrust.size() && i < d.motorDirections.size(); ++i) {
+            b2Vec2 thrustDir = rotateVector(d.motorDirections[i], d.transform.q);
+            netForce.x += thrustDir.x * d.thrust[i];
+            netForce.y += thrustDir.y * d.thrust[i];
+        }
+        addNetForce(d.transform.p, netForce, view, sumColor, vertColor, horizColor);
+    }
+}
+
+void ForceArrowDrawer::addNetForces(const swarm& drones, const viewTransform& view,
+                                     sf::Color sumColor, sf::Color vertColor, sf::Color horizColor) {
+    for (size_t d = 0; d < drones.size(); ++d) {
+        b2Rot rot = drones.getRotation(d);
+        const float* thrust = drones.getLastThrustValues(d);
+        b2Vec2 netForce = { 0.0f, -drones.gravitationalForce(d) };
+        for (size_t i = 0; i < drones.motorCount(d); ++i) {
+            b2Vec2 thrustDir = rotateVector(drones.getMotorDirection(d, i), rot);
+            netForce.x += thrustDir.x * thrust[i];
+            netForce.y += thrustDir.y * thrust[i];
+        }
+        addNetForce(drones.getPosition(d), netForce, view, sumColor, vertColor, horizColor);
+    }
+}
+
+void ForceArrowDrawer::addMotorThrusts(std::span<const droneSnapshot> drones, const viewTransform& view, sf::Color color) {
+    for (const droneSnapshot& d : drones) {
+        for (size_t i = 0; i < d.thrust.size() && i < d.motorPositions.size() && i < d.motorDirections.size(); ++i) {
+            if (d.thrust[i] <= 0.0f) continue;
+            b2Vec2 start = b2TransformPoint(d.transform, d.motorPositions[i]);
+            b2Vec2 dir = rotateVector(d.motorDirections[i], d.transform.q);
+            float len = std::clamp(d.thrust[i] * scaleFactor, 10.0f, 150.0f);
+            addArrow(view.apply(start.x, start.y), view.apply(start.x + dir.x * len, start.y + dir.y * len), color);
+        }
+    }
+}
+
+void ForceArrowDrawer::addMotorThrusts(const swarm& drones, const viewTransform& view, sf::Color color) {
+    for (size_t d = 0; d < drones.size(); ++d) {
+        b2Transform transform = { drones.getPosition(d), drones.getRotation(d) };
+        const float* thrust = drones.getLastThrustValues(d);
+        for (size_t i = 0; i < drones.motorCount(d); ++i) {
+            if (thrust[i] <= 0.0f) continue;
+            b2Vec2 start = b2TransformPoint(transform, drones.getMotorPosition(d, i));
+            b2Vec2 dir = rotateVector(drones.getMotorDirection(d, i), transform.q);
+            float len = std::clamp(thrust[i] * scaleFactor, 10.0f, 150.0f);
+            addArrow(view.apply(start.x, start.y), view.apply(start.x + dir.x * len, start.y + dir.y * len), color);
+        }
+    }
+}
+
+void ForceArrowDrawer::flush(sf::RenderTarget& target) {
+    if (batch.getVertexCount() > 0) {
+        target.draw(batch);
     }
+    batch.clear();
 }
@@ -0,0 +1,356 @@
+#include <SFML/Graphics.hpp>
+#include <SFML/Window.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include "../include/frame_capture.hpp"
+
+#if defined(_WIN32)
+#define CAPTURE_GL_CALL __stdcall
+#else
+#define CAPTURE_GL_CALL
+#endif
+
+// The few buffer-object entry points readback needs, loaded through SFML so
+// the front end does not link OpenGL or an extension loader itself
+struct frameCapture::glFunctions {
+    static constexpr unsigned int pixelPackBuffer = 0x88EB; // GL_PIXEL_PACK_BUFFER
+    static constexpr unsigned int streamRead = 0x88E1;      // GL_STREAM_READ
+    static constexpr unsigned int readOnly = 0x88B8;        // GL_READ_ONLY
+    static constexpr unsigned int rgba = 0x1908;            // GL_RGBA
+    static constexpr unsigned int unsignedByte = 0x1401;    // GL_UNSIGNED_BYTE
+
+    void (CAPTURE_GL_CALL* genBuffers)(int, unsigned int*) = nullptr;
+    void (CAPTURE_GL_CALL* deleteBuffers)(int, const unsigned int*) = nullptr;
+    void (CAPTURE_GL_CALL* bindBuffer)(unsigned int, unsigned int) = nullptr;
+    void (CAPTURE_GL_CALL* bufferData)(unsigned int, std::ptrdiff_t, const void*, unsigned int) = nullptr;
+    void* (CAPTURE_GL_CALL* mapBuffer)(unsigned int, unsigned int) = nullptr;
+    unsigned char (CAPTURE_GL_CALL* unmapBuffer)(unsigned int) = nullptr;
+    void (CAPTURE_GL_CALL* readPixels)(int, int, int, int, unsigned int, unsigned int, void*) = nullptr;
+
+    template <typename F>
+    static void load(F& function, const char* name) {
+        function = reinterpret_cast<F>(sf::Context::getFunction(name));
+    }
+
+    // Needs a current context
+    bool load() {
+        load(genBuffers, "glGenBuffers");
+        load(deleteBuffers, "glDeleteBuffers");
+        load(bindBuffer, "glBindBuffer");
+        load(bufferData, "glBufferData");
+        load(mapBuffer, "glMapBuffer");
+        load(unmapBuffer, "glUnmapBuffer");
+        load(readPixels, "glReadPixels");
+        return genBuffers && deleteBuffers && bindBuffer && bufferData && mapBuffer && unmapBuffer && readPixels;
+    }
+};
+
+// Readbacks kept in flight; by the time a buffer is reused the GPU has long finished it
+static const size_t packBufferCount = 3;
+
+captureFormat captureFormatFor(const std::string& path) {
+    if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".y4m") == 0) {
+        return captureFormat::y4m;
+    }
+    return captureFormat::pngSequence;
+}
+
+frameCapture::frameCapture() {
+}
+
+frameCapture::~frameCapture() {
+    if (!isOpen()) {
+        return;
+    }
+    // Without the source texture the frames still on the GPU cannot be read back
+    pendingReadbacks.clear();
+    if (!packBuffers.empty()) {
+        sf::Context context;
+        releasePackBuffers();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    frameQueued.notify_all();
+    encoder.join();
+}
+
+bool frameCapture::open(const captureConfig& config) {
+    if (isOpen()) {
+        std::cerr << "Capture already open" << std::endl;
+        return false;
+    }
+    if (config.path.empty() || config.width == 0 || config.height == 0 || config.fps == 0 || config.bufferCount == 0) {
+        std::cerr << "Invalid capture settings" << std::endl;
+        return false;
+    }
+    this->config = config;
+    if (config.format == captureFormat::y4m) {
+        stream.open(config.path, std::ios::binary | std::ios::trunc);
+        if (!stream) {
+            std::cerr << "Failed to open " << config.path << std::endl;
+            return false;
+        }
+        // C420jpeg: full-range BT.601 with centred chroma, what RGB sources map to
+        stream << "YUV4MPEG2 W" << config.width << " H" << config.height << " F" << config.fps << ":1 Ip A1:1 C420jpeg\n";
+    }
+
+    stats = captureStats();
+    nextFrame = 0;
+    closing = false;
+    freeBuffers.clear();
+    encodeQueue.clear();
+    for (size_t i = 0; i < config.bufferCount; ++i) {
+        auto frame = std::make_unique<frameBuffer>();
+        frame->pixels.resize(static_cast<size_t>(config.width) * config.height * 4);
+        freeBuffers.push_back(std::move(frame));
+    }
+    encoder = std::thread(&frameCapture::encoderMain, this);
+    return true;
+}
+
+std::unique_ptr<frameCapture::frameBuffer> frameCapture::acquireBuffer() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (freeBuffers.empty()) {
+        if (config.dropWhenBusy) {
+            ++stats.dropped;
+            return nullptr;
+        }
+        ++stats.bufferWaits;
+        bufferFreed.wait(lock, [this] { return !freeBuffers.empty(); });
+    }
+    std::unique_ptr<frameBuffer> frame = std::move(freeBuffers.back());
+    freeBuffers.pop_back();
+    return frame;
+}
+
+void frameCapture::queueFrame(std::unique_ptr<frameBuffer> frame) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        encodeQueue.push_back(std::move(frame));
+    }
+    frameQueued.notify_one();
+}
+
+bool frameCapture::capture(sf::RenderTexture& source) {
+    if (!isOpen()) {
+        return false;
+    }
+    if (source.getSize() != sf::Vector2u(config.width, config.height)) {
+        std::cerr << "Capture source is " << source.getSize().x << "x" << source.getSize().y << ", expected "
+                  << config.width << "x" << config.height << std::endl;
+        return false;
+    }
+    if (!source.setActive(true)) {
+        std::cerr << "Failed to activate the capture source" << std::endl;
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.submitted;
+    }
+
+    if (!gl) {
+        gl = std::make_unique<glFunctions>();
+        if (gl->load()) {
+            size_t bytes = static_cast<size_t>(config.width) * config.height * 4;
+            packBuffers.resize(packBufferCount);
+            gl->genBuffers(static_cast<int>(packBuffers.size()), packBuffers.data());
+            for (unsigned int buffer : packBuffers) {
+                gl->bindBuffer(glFunctions::pixelPackBuffer, buffer);
+                gl->bufferData(glFunctions::pixelPackBuffer, static_cast<std::ptrdiff_t>(bytes), nullptr, glFunctions::streamRead);
+            }
+            gl->bindBuffer(glFunctions::pixelPackBuffer, 0);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.asyncReadback = !packBuffers.empty();
+    }
+
+    if (packBuffers.empty()) {
+        std::unique_ptr<frameBuffer> frame = acquireBuffer();
+        uint64_t index = nextFrame++;
+        if (!frame) {
+            return true;
+        }
+        sf::Image image = source.getTexture().copyToImage();
+        std::memcpy(frame->pixels.data(), image.getPixelsPtr(), frame->pixels.size());
+        frame->index = index;
+        frame->bottomUp = false;
+        queueFrame(std::move(frame));
+        return true;
+    }
+
+    if (pendingReadbacks.size() == packBuffers.size()) {
+        collectOldestReadback(source);
+    }
+    gl->bindBuffer(glFunctions::pixelPackBuffer, packBuffers[nextFrame % packBuffers.size()]);
+    gl->readPixels(0, 0, static_cast<int>(config.width), static_cast<int>(config.height), glFunctions::rgba, glFunctions::unsignedByte, nullptr);
+    gl->bindBuffer(glFunctions::pixelPackBuffer, 0);
+    pendingReadbacks.push_back(nextFrame++);
+    return true;
+}
+
+void frameCapture::collectOldestReadback(sf::RenderTexture& source) {
+    uint64_t index = pendingReadbacks.front();
+    pendingReadbacks.pop_front();
+    std::unique_ptr<frameBuffer> frame = acquireBuffer();
+    if (!frame) {
+        return;
+    }
+    // A frame that cannot be read back is dropped, and its buffer goes back to the pool
+    bool copied = false;
+    if (source.setActive(true)) {
+        gl->bindBuffer(glFunctions::pixelPackBuffer, packBuffers[index % packBuffers.size()]);
+        const void* mapped = gl->mapBuffer(glFunctions::pixelPackBuffer, glFunctions::readOnly);
+        copied = mapped != nullptr;
+        if (copied) {
+            std::memcpy(frame->pixels.data(), mapped, frame->pixels.size());
+            gl->unmapBuffer(glFunctions::pixelPackBuffer);
+        }
+        gl->bindBuffer(glFunctions::pixelPackBuffer, 0);
+    }
+    if (!copied) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.dropped;
+        freeBuffers.push_back(std::move(frame));
+        return;
+    }
+    frame->index = index;
+    frame->bottomUp = true;
+    queueFrame(std::move(frame));
+}
+
+void frameCapture::releasePackBuffers() {
+    if (gl && !packBuffers.empty()) {
+        gl->deleteBuffers(static_cast<int>(packBuffers.size()), packBuffers.data());
+    }
+    packBuffers.clear();
+    gl.reset();
+}
+
+void frameCapture::close(sf::RenderTexture& source) {
+    if (!isOpen()) {
+        return;
+    }
+    while (!pendingReadbacks.empty()) {
+        collectOldestReadback(source);
+    }
+    if (!packBuffers.empty() && source.setActive(true)) {
+        releasePackBuffers();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    frameQueued.notify_all();
+    encoder.join();
+    if (stream.is_open()) {
+        stream.close();
+    }
+}
+
+captureStats frameCapture::getStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void frameCapture::encoderMain() {
+    bool reportedFailure = false;
+    while (true) {
+        std::unique_ptr<frameBuffer> frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            frameQueued.wait(lock, [this] { return closing || !encodeQueue.empty(); });
+            if (encodeQueue.empty()) {
+                break;
+            }
+            frame = std::move(encodeQueue.front());
+            encodeQueue.pop_front();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        bool written = config.format == captureFormat::y4m ? writeY4m(*frame) : writePng(*frame);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!written && !reportedFailure) {
+            std::cerr << "Failed to write captured frame " << frame->index << std::endl;
+            reportedFailure = true;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.encodeSeconds += seconds;
+            if (written) {
+                ++stats.written;
+            } else {
+                ++stats.dropped;
+            }
+            freeBuffers.push_back(std::move(frame));
+        }
+        bufferFreed.notify_one();
+    }
+}
+
+bool frameCapture::writePng(const frameBuffer& frame) {
+    const uint8_t* pixels = frame.pixels.data();
+    if (frame.bottomUp) {
+        size_t rowBytes = static_cast<size_t>(config.width) * 4;
+        scratch.resize(frame.pixels.size());
+        for (unsigned int y = 0; y < config.height; ++y) {
+            std::memcpy(scratch.data() + y * rowBytes, pixels + (config.height - 1 - y) * rowBytes, rowBytes);
+        }
+        pixels = scratch.data();
+    }
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "_%06llu.png", static_cast<unsigned long long>(frame.index));
+    sf::Image image(sf::Vector2u(config.width, config.height), pixels);
+    return image.saveToFile(config.path + suffix);
+}
+
+// Full-range BT.601 in 16.16 fixed point; chroma is the average of each 2x2 block
+bool frameCapture::writeY4m(const frameBuffer& frame) {
+    const unsigned int width = config.width;
+    const unsigned int height = config.height;
+    const unsigned int chromaWidth = (width + 1) / 2;
+    const unsigned int chromaHeight = (height + 1) / 2;
+    scratch.resize(static_cast<size_t>(width) * height + 2 * static_cast<size_t>(chromaWidth) * chromaHeight);
+    uint8_t* yPlane = scratch.data();
+    uint8_t* uPlane = yPlane + static_cast<size_t>(width) * height;
+    uint8_t* vPlane = uPlane + static_cast<size_t>(chromaWidth) * chromaHeight;
+
+    auto row = [&](unsigned int y) {
+        unsigned int source = frame.bottomUp ? height - 1 - y : y;
+        return frame.pixels.data() + static_cast<size_t>(source) * width * 4;
+    };
+
+    for (unsigned int y = 0; y < height; ++y) {
+        const uint8_t* p = row(y);
+        uint8_t* out = yPlane + static_cast<size_t>(y) * width;
+        for (unsigned int x = 0; x < width; ++x, p += 4) {
+            out[x] = static_cast<uint8_t>((19595 * p[0] + 38470 * p[1] + 7471 * p[2] + 32768) >> 16);
+        }
+    }
+    for (unsigned int cy = 0; cy < chromaHeight; ++cy) {
+        const uint8_t* top = row(2 * cy);
+        const uint8_t* bottom = row(std::min(2 * cy + 1, height - 1));
+        for (unsigned int cx = 0; cx < chromaWidth; ++cx) {
+            unsigned int x0 = 2 * cx * 4;
+            unsigned int x1 = std::min(2 * cx + 1, width - 1) * 4;
+            int r = top[x0] + top[x1] + bottom[x0] + bottom[x1];
+            int g = top[x0 + 1] + top[x1 + 1] + bottom[x0 + 1] + bottom[x1 + 1];
+            int b = top[x0 + 2] + top[x1 + 2] + bottom[x0 + 2] + bottom[x1 + 2];
+            // Sums of four samples, hence the extra >> 2
+            int u = 128 + ((-11059 * r - 21709 * g + 32768 * b + (1 << 17)) >> 18);
+            int v = 128 + ((32768 * r - 27439 * g - 5329 * b + (1 << 17)) >> 18);
+            uPlane[static_cast<size_t>(cy) * chromaWidth + cx] = static_cast<uint8_t>(std::clamp(u, 0, 255));
+            vPlane[static_cast<size_t>(cy) * chromaWidth + cx] = static_cast<uint8_t>(std::clamp(v, 0, 255));
+        }
+    }
+
+    stream.write("FRAME\n", 6);
+    stream.write(reinterpret_cast<const char*>(scratch.data()), static_cast<std::streamsize>(scratch.size()));
+    return static_cast<bool>(stream);
+}
@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <thread>
+#include "../include/frame_scheduler.hpp"
+
+void sleepPrecise(schedulerClock::time_point deadline, schedulerClock::duration spinMargin) {
+    if (schedulerClock::now() + spinMargin < deadline) {
+        std::this_thread::sleep_until(deadline - spinMargin);
+    }
+    while (schedulerClock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+fixedStepScheduler::fixedStepScheduler(double stepSeconds, int maxStepsPerTick, schedulerClock::duration spinMargin) {
+    this->period = std::chrono::duration_cast<schedulerClock::duration>(std::chrono::duration<double>(stepSeconds));
+    this->spinMargin = spinMargin;
+    this->maxStepsPerTick = std::max(maxStepsPerTick, 1);
+    reset();
+}
+
+void fixedStepScheduler::reset() {
+    lastTick = schedulerClock::now();
+    accumulator = schedulerClock::duration::zero();
+    stats = schedulerStats();
+}
+
+int fixedStepScheduler::advance() {
+    auto now = schedulerClock::now();
+    accumulator += now - lastTick;
+    lastTick = now;
+
+    double debt = std::chrono::duration<double>(accumulator) / std::chrono::duration<double>(period);
+    ++stats.ticks;
+    stats.totalStepDebt += debt;
+    stats.maxStepDebt = std::max(stats.maxStepDebt, debt);
+    if (accumulator > 2 * period) {
+        ++stats.deadlineMisses;
+        stats.maxLatenessSeconds = std::max(stats.maxLatenessSeconds,
+                                            std::chrono::duration<double>(accumulator - period).count());
+    }
+
+    int due = static_cast<int>(accumulator / period);
+    if (due > maxStepsPerTick) {
+        stats.droppedSteps += due - maxStepsPerTick;
+        accumulator -= (due - maxStepsPerTick) * period;
+        due = maxStepsPerTick;
+    }
+    accumulator -= due * period;
+    stats.steps += due;
+    if (due > 1) {
+        ++stats.catchUpTicks;
+    }
+    return due;
+}
+
+void fixedStepScheduler::waitForNextStep() const {
+    sleepPrecise(lastTick + (period - accumulator), spinMargin);
+}
+
+double fixedStepScheduler::alpha() const {
+    return std::chrono::duration<double>(accumulator) / std::chrono::duration<double>(period);
+}
+
+frameLimiter::frameLimiter(double rateHz, schedulerClock::duration spinMargin) {
+    this->period = rateHz > 0.0
+        ? std::chrono::duration_cast<schedulerClock::duration>(std::chrono::duration<double>(1.0 / rateHz))
+        : schedulerClock::duration::zero();
+    this->spinMargin = spinMargin;
+    this->next = schedulerClock::now() + period;
+}
+
+void frameLimiter::wait() {
+    ++stats.ticks;
+    if (period == schedulerClock::duration::zero()) {
+        return;
+    }
+    auto now = schedulerClock::now();
+    if (now > next) {
+        double late = std::chrono::duration<double>(now - next).count();
+        stats.maxLatenessSeconds = std::max(stats.maxLatenessSeconds, late);
+        ++stats.deadlineMisses;
+        next = now + period;
+        return;
+    }
+    sleepPrecise(next, spinMargin);
+    next += period;
+}
@@ -0,0 +1,83 @@
+#include "../include/physics_loop.hpp"
+#include "../include/profiler.hpp"
+
+physicsLoop::physicsLoop(simulation& sim, float rateHz, int maxCatchUpSteps, schedulerClock::duration spinMargin)
+    : sim(sim),
+      rateHz(rateHz),
+      recorder(nullptr),
+      observer(nullptr),
+      running(false),
+      requestedTarget(sim.getTargetAltitude()),
+      requestedEnabled(sim.isControllerEnabled()),
+      requestedController(sim.getControllerKind()),
+      scheduler(1.0 / rateHz, maxCatchUpSteps, spinMargin) {
+}
+
+physicsLoop::~physicsLoop() {
+    stop();
+}
+
+void physicsLoop::track(entityHandle entity) {
+    tracked.push_back(entity);
+}
+
+void physicsLoop::start() {
+    if (running.exchange(true)) {
+        return;
+    }
+    // Publish the initial state so the renderer has something to show immediately
+    publish(0);
+    worker = std::thread(&physicsLoop::run, this);
+}
+
+void physicsLoop::stop() {
+    running.store(false);
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void physicsLoop::publish(uint64_t step) {
+    PROFILE_ZONE("publishSnapshot");
+    worldSnapshot& snapshot = snapshots.writeBuffer();
+    snapshot.step = step;
+    snapshot.time = step * static_cast<double>(sim.getConfig().timeStep);
+    snapshot.targetAltitude = sim.getTargetAltitude();
+    snapshot.controllerEnabled = sim.isControllerEnabled();
+    captureBodies(sim.getEntities(), tracked, snapshot.bodyTransforms);
+    captureDrone(sim.getDrone(), snapshot.droneState);
+    snapshots.publish();
+}
+
+// Simulated time follows wall-clock time: every wake-up runs the steps that came
+// due since the last one, up to the catch-up limit, then publishes once
+void physicsLoop::run() {
+    uint64_t step = 0;
+    scheduler.reset();
+
+    while (running.load(std::memory_order_relaxed)) {
+        int due = scheduler.advance();
+        for (int i = 0; i < due; ++i) {
+            float target = requestedTarget.load(std::memory_order_relaxed);
+            if (target != sim.getTargetAltitude()) {
+                sim.setTargetAltitude(target);
+            }
+            sim.setControllerEnabled(requestedEnabled.load(std::memory_order_relaxed));
+            sim.setControllerKind(requestedController.load(std::memory_order_relaxed));
+
+            sim.step();
+            ++step;
+            if (recorder) {
+                PROFILE_ZONE("record");
+                recorder->record(step, sim);
+            }
+            if (observer) {
+                observer->afterStep(step, sim);
+            }
+        }
+        if (due > 0) {
+            publish(step);
+        }
+        scheduler.waitForNextStep();
+    }
+}
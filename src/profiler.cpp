@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "../include/profiler.hpp"
+
+using namespace profiling;
+
+// Buffers are owned here rather than by their threads, so events stay readable
+// after a thread exits, until another thread takes the buffer over
+static std::mutex registryMutex;
+static std::vector<std::unique_ptr<threadBuffer>> registry;
+static std::vector<threadBuffer*> retired;
+static uint32_t nextThreadIndex = 0;
+
+namespace {
+struct bufferLease {
+    threadBuffer* buffer = nullptr;
+    ~bufferLease() {
+        if (buffer) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            retired.push_back(buffer);
+        }
+    }
+};
+}
+
+threadBuffer& profiling::localBuffer() {
+    thread_local bufferLease lease;
+    if (!lease.buffer) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        if (retired.empty()) {
+            registry.push_back(std::make_unique<threadBuffer>(nextThreadIndex++));
+            lease.buffer = registry.back().get();
+        } else {
+            lease.buffer = retired.back();
+            retired.pop_back();
+            lease.buffer->reset(nextThreadIndex++);
+        }
+    }
+    return *lease.buffer;
+}
+
+void threadBuffer::reset(uint32_t threadIndex) {
+    for (slot& s : slots) {
+        s.sequence.store(0, std::memory_order_relaxed);
+    }
+    head.store(0, std::memory_order_release);
+    this->threadIndex = threadIndex;
+}
+
+void threadBuffer::copyRecent(size_t maxEvents, std::vector<capturedEvent>& out) const {
+    uint64_t end = head.load(std::memory_order_acquire);
+    uint64_t count = std::min<uint64_t>({ end, capacity, maxEvents });
+    for (uint64_t i = end - count; i < end; ++i) {
+        const slot& s = slots[i & (capacity - 1)];
+        if (s.sequence.load(std::memory_order_acquire) != i + 1) {
+            continue;
+        }
+        zoneEvent event = { s.name.load(std::memory_order_relaxed),
+                            s.startNs.load(std::memory_order_relaxed),
+                            s.durationNs.load(std::memory_order_relaxed) };
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s.sequence.load(std::memory_order_relaxed) == i + 1) {
+            out.push_back({ event, threadIndex });
+        }
+    }
+}
+
+std::vector<capturedEvent> profiling::capture(size_t maxEventsPerThread) {
+    std::vector<capturedEvent> events;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& buffer : registry) {
+        buffer->copyRecent(maxEventsPerThread, events);
+    }
+    return events;
+}
+
+std::vector<zoneStats> profiling::summarize(size_t recentEventsPerThread) {
+    std::vector<capturedEvent> events = capture(recentEventsPerThread);
+    std::unordered_map<const char*, std::vector<uint64_t>> durations;
+    for (const capturedEvent& e : events) {
+        durations[e.event.name].push_back(e.event.durationNs);
+    }
+
+    std::vector<zoneStats> stats;
+    for (auto& [name, values] : durations) {
+        auto percentile = [&values](double p) {
+            size_t index = std::min(values.size() - 1, static_cast<size_t>(p * values.size()));
+            std::nth_element(values.begin(), values.begin() + index, values.end());
+            return values[index] / 1000.0;
+        };
+        stats.push_back({ name, values.size(), percentile(0.50), percentile(0.99) });
+    }
+    std::sort(stats.begin(), stats.end(), [](const zoneStats& a, const zoneStats& b) {
+        return std::string(a.name) < std::string(b.name);
+    });
+    return stats;
+}
+
+bool profiling::writeChromeTrace(const std::string& path) {
+    std::vector<capturedEvent> events = capture();
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    uint64_t origin = UINT64_MAX;
+    for (const capturedEvent& e : events) {
+        origin = std::min(origin, e.event.startNs);
+    }
+
+    out << "{\"traceEvents\":[\n";
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    for (size_t i = 0; i < events.size(); ++i) {
+        const capturedEvent& e = events[i];
+        out << "{\"name\":\"" << e.event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.threadIndex
+            << ",\"ts\":" << (e.event.startNs - origin) / 1000.0
+            << ",\"dur\":" << e.event.durationNs / 1000.0 << "}"
+            << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+    out << "],\"displayTimeUnit\":\"ms\"}\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <cstdio>
+#include "../include/profiler_overlay.hpp"
+#include "../include/bitmap_text.hpp"
+
+ProfilerOverlay::ProfilerOverlay(std::chrono::milliseconds refreshInterval)
+    : refreshInterval(refreshInterval), visible(false) {
+    batch.setPrimitiveType(sf::PrimitiveType::Triangles);
+}
+
+void ProfilerOverlay::update() {
+    if (!visible) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastRefresh < refreshInterval) {
+        return;
+    }
+    lastRefresh = now;
+    stats = profiling::summarize();
+    rebuild();
+}
+
+void ProfilerOverlay::rebuild() {
+    const float pixel = 2.0f;
+    const float rowHeight = 9.0f * pixel;
+    const float labelWidth = 24.0f * 6.0f * pixel;
+    const float barWidth = 160.0f;
+    const sf::Vector2f origin = { 10.0f, 10.0f };
+
+    batch.clear();
+    double scaleUs = 1.0;
+    for (const auto& s : stats) {
+        scaleUs = std::max(scaleUs, s.p99Us);
+    }
+
+    float height = rowHeight * (stats.size() + 1) + 8.0f;
+    appendRect(batch, origin - sf::Vector2f(4.0f, 4.0f), { labelWidth + barWidth + 24.0f, height }, sf::Color(0, 0, 0, 180));
+    appendText(batch, origin, "ZONE            P50/P99 US", pixel, sf::Color::White);
+
+    char line[64];
+    for (size_t i = 0; i < stats.size(); ++i) {
+        const auto& s = stats[i];
+        float y = origin.y + rowHeight * (i + 1);
+        std::snprintf(line, sizeof(line), "%-14.14s %6.1f %6.1f", s.name, s.p50Us, s.p99Us);
+        appendText(batch, { origin.x, y }, line, pixel, sf::Color(200, 200, 200));
+
+        float p50 = static_cast<float>(s.p50Us / scaleUs) * barWidth;
+        float p99 = static_cast<float>(s.p99Us / scaleUs) * barWidth;
+        float barX = origin.x + labelWidth + 10.0f;
+        appendRect(batch, { barX, y }, { std::max(p50, 1.0f), 7.0f * pixel }, sf::Color(80, 200, 120));
+        appendRect(batch, { barX + p99 - 1.0f, y }, { 2.0f, 7.0f * pixel }, sf::Color(240, 80, 80));
+    }
+}
+
+void ProfilerOverlay::draw(sf::RenderTarget& target) {
+    if (visible && batch.getVertexCount() > 0) {
+        target.draw(batch);
+    }
+}
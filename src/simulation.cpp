@@ -0,0 +1,260 @@
+#include <box2d/box2d.h>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include "../include/simulation.hpp"
+#include "../include/profiler.hpp"
+#include "../include/thread_pool.hpp"
+
+static b2WorldId createWorld(const simulationConfig& config) {
+    b2WorldDef worldDef = b2DefaultWorldDef();
+    worldDef.gravity = {0.0f, -9.81f};
+    if (config.multithreadedPhysics) {
+        sharedThreadPool().attach(worldDef);
+    }
+    return b2CreateWorld(&worldDef);
+}
+
+// RGBA; the target altitude line is drawn red
+static const uint32_t targetLineColor = 0xFF0000FF;
+
+// Ground center 5 + half height 10
+static const float groundTop = 15.0f;
+
+// Start the drone just above the ground surface
+static float groundSurface(const simulationConfig& config) {
+    return groundTop + config.droneHeight / 2.0f;
+}
+
+// Keep mass similar to the original 50x50 body with density 1.0
+static float droneDensity(const simulationConfig& config) {
+    float originalArea = 50.0f * 50.0f;
+    float newArea = config.droneWidth * config.droneHeight;
+    return originalArea / newArea;
+}
+
+// Outer rotors sit at ~45% from center on each side, slightly above center
+static std::vector<b2Vec2> motorLayout(const simulationConfig& config) {
+    return control::evenMotorPositions(config.motorCount, config.droneWidth * 0.45f, config.droneHeight * 0.3f);
+}
+
+static std::optional<windField> sceneWind(const simulationConfig& config) {
+    if (!config.enableWind) {
+        return std::nullopt;
+    }
+    return windField(windConfigOver(config.wind, { 0.0f, 0.0f }, { config.worldWidth, config.worldHeight }, config.wind.cellSize));
+}
+
+// About a sixth of the span per rotor
+static float rotorRadius(const simulationConfig& config) {
+    return config.droneWidth * 0.15f;
+}
+
+// In 2D the areas are lengths: the airframe's height faces sideways flow, its width vertical flow
+airframeDrag airframeDragFor(const simulationConfig& config) {
+    airframeDrag settings;
+    settings.halfSpan = config.droneWidth / 2.0f;
+    settings.frontalArea = config.droneHeight;
+    settings.planformArea = config.droneWidth;
+    return settings;
+}
+
+// The filter's noise assumptions follow the simulated sensors
+static estimation::estimatorConfig estimatorSettings(const simulationConfig& config) {
+    estimation::estimatorConfig settings;
+    settings.accelNoise = std::max(config.accelNoise.stdDev, 1.0e-3f);
+    settings.accelBiasWalk = std::max(config.accelNoise.biasWalk, 1.0e-4f);
+    settings.baroNoise = std::max(config.baroNoise.stdDev, 1.0e-3f);
+    return settings;
+}
+
+simulation::simulation(const simulationConfig& config)
+    : config(config),
+      worldId(createWorld(config)),
+      entities(worldId, 3),
+      droneEntity(entities.spawnDrone({config.worldWidth / 2.0f, groundSurface(config)}, config.droneHeight, config.droneWidth, droneDensity(config),
+                                      motorLayout(config), control::verticalMotorDirections(config.motorCount), config.maxThrustPerMotor)),
+      groundEntity(entities.spawnBox({config.worldWidth / 2.0f, 5.0f}, 10.0f, 2 * config.worldWidth, b2_staticBody)),
+      targetEntity(entities.spawnBox({config.worldWidth / 2.0f, groundSurface(config)}, 2.0f, 2 * config.worldWidth, b2_kinematicBody, false, 1.0f, targetLineColor)),
+      hover(entities.getDrone(droneEntity), config.kp, config.ki, config.kd),
+      planner(entities.getDrone(droneEntity)),
+      imuSensor(config.accelNoise, config.gyroNoise, config.sensorSeed),
+      baro(config.baroNoise, config.sensorSeed + 1),
+      estimator(estimatorSettings(config)),
+      wind(sceneWind(config)),
+      drag(airframeDragFor(config)),
+      targetAltitude(groundSurface(config)),
+      controllerEnabled(true),
+      stepCount(0) {
+    // Altitude loop reuses the hover gains; attitude loop is placed at a natural
+    // frequency of 4 rad/s with damping 0.8 for this airframe's inertia
+    auto& altitude = cascade.stage<0>();
+    altitude.pid.kp = config.kp;
+    altitude.pid.ki = config.ki;
+    altitude.pid.kd = config.kd;
+
+    float inertia = b2Body_GetMassData(getDroneBody().bodyId).rotationalInertia;
+    const float omega = 4.0f;
+    const float zeta = 0.8f;
+    auto& attitude = cascade.stage<1>();
+    attitude.pid.kp = inertia * omega * omega;
+    attitude.pid.kd = inertia * 2.0f * zeta * omega;
+
+    float maxArm = 0.0f;
+    for (const b2Vec2& position : getDrone().getMotorPositions()) {
+        maxArm = std::max(maxArm, std::abs(position.x));
+    }
+    auto& saturation = cascade.stage<2>();
+    saturation.maxCollective = getDrone().getMaxTotalThrust();
+    saturation.maxTorque = config.maxThrustPerMotor * maxArm;
+
+    estimator.reset(getDroneBody().bodyId);
+    lastEstimate = control::measure(getDrone());
+}
+
+simulation::~simulation() {
+    b2DestroyWorld(worldId);
+}
+
+void simulation::setAltitudeGains(float kp, float ki, float kd) {
+    config.kp = kp;
+    config.ki = ki;
+    config.kd = kd;
+    hover.setGains(kp, ki, kd);
+    auto& altitude = cascade.stage<0>();
+    altitude.pid.kp = kp;
+    altitude.pid.ki = ki;
+    altitude.pid.kd = kd;
+}
+
+void simulation::setTargetAltitude(float altitude) {
+    targetAltitude = altitude;
+    b2Body_SetTransform(getTargetLine().bodyId, {config.worldWidth / 2.0f, targetAltitude}, b2MakeRot(0.0f));
+}
+
+const char* controllerName(controllerKind kind) {
+    switch (kind) {
+    case controllerKind::hover: return "hover";
+    case controllerKind::cascade: return "cascade";
+    case controllerKind::mppi: return "mppi";
+    }
+    return "unknown";
+}
+
+void simulation::setControllerKind(controllerKind kind) {
+    if (kind == config.controller) {
+        return;
+    }
+    config.controller = kind;
+    switch (kind) {
+    case controllerKind::hover: hover.reset(); break;
+    case controllerKind::cascade: cascade.reset(); break;
+    case controllerKind::mppi: planner.reset(); break;
+    }
+}
+
+void simulation::step() {
+    if (config.useEstimator) {
+        PROFILE_ZONE("estimate");
+        estimator.predict(imuSensor.sample(getDroneBody().bodyId, config.timeStep), config.timeStep);
+        estimator.correctAltitude(baro.sample(getDroneBody().bodyId, config.timeStep));
+        lastEstimate = estimator.estimate(getDrone().gravitationalForce());
+    }
+    if (controllerEnabled) {
+        PROFILE_ZONE("control");
+        control::setpoint sp = { config.worldWidth / 2.0f, targetAltitude };
+        if (config.controller == controllerKind::cascade) {
+            control::measurement m = config.useEstimator ? lastEstimate : control::measure(getDrone());
+            control::applyCommand(getDrone(), cascade.update(m, sp, config.timeStep));
+        } else if (config.controller == controllerKind::mppi) {
+            control::measurement m = config.useEstimator ? lastEstimate : control::measure(getDrone());
+            planner.update(m, sp, config.timeStep);
+        } else if (config.useEstimator) {
+            hover.update(targetAltitude, lastEstimate.y, lastEstimate.velY, config.timeStep);
+        } else {
+            hover.update(targetAltitude, config.timeStep);
+        }
+    }
+    if (wind || config.groundEffect) {
+        PROFILE_ZONE("airLoads");
+        applyAirLoads();
+    }
+    {
+        PROFILE_ZONE("b2World_Step");
+        b2World_Step(worldId, config.timeStep, config.subStepCount);
+    }
+    ++stepCount;
+}
+
+// The field is a function of simulated time, so checkpoints need not store it.
+// Box2D holds applied forces for every substep of the next step.
+void simulation::applyAirLoads() {
+    b2BodyId bodyId = getDroneBody().bodyId;
+    b2Transform transform = b2Body_GetTransform(bodyId);
+    if (wind) {
+        wind->advance(stepCount * config.timeStep);
+        b2Vec2 velocity = b2Body_GetLinearVelocity(bodyId);
+        windBodies bodies;
+        bodies.count = 1;
+        bodies.posX = &transform.p.x;
+        bodies.posY = &transform.p.y;
+        bodies.rotC = &transform.q.c;
+        bodies.rotS = &transform.q.s;
+        bodies.velX = &velocity.x;
+        bodies.velY = &velocity.y;
+        b2Vec2 force;
+        float torque;
+        computeWindLoads(*wind, drag, bodies, { &force.x, &force.y, &torque });
+        b2Body_ApplyForceToCenter(bodyId, force, true);
+        b2Body_ApplyTorque(bodyId, torque, true);
+    }
+    if (config.groundEffect && controllerEnabled) {
+        float thrust = 0.0f;
+        std::span<const float> values = getDrone().getLastThrustValues();
+        std::span<const b2Vec2> directions = getDrone().getMotorDirections();
+        for (size_t m = 0; m < values.size(); ++m) {
+            thrust += values[m] * directions[m].y;
+        }
+        float extra = (groundEffectGain(rotorRadius(config), transform.p.y - groundTop) - 1.0f) * thrust;
+        b2Body_ApplyForceToCenter(bodyId, b2RotateVector(transform.q, { 0.0f, extra }), true);
+    }
+}
+
+void simulation::saveCheckpoint(checkpoint& out) {
+    out.step = stepCount;
+    out.targetAltitude = targetAltitude;
+    out.controllerEnabled = controllerEnabled;
+    out.drone = captureBodyState(getDroneBody().bodyId);
+    out.ground = captureBodyState(getGround().bodyId);
+    out.targetLine = captureBodyState(getTargetLine().bodyId);
+    std::span<const float> thrust = getDrone().getLastThrustValues();
+    out.thrust.assign(thrust.begin(), thrust.end());
+    out.controller = hover.getState();
+    out.gains = hover.getGains();
+    out.cascade = cascade;
+    out.activeController = config.controller;
+    out.planner = planner.getState();
+    out.imu = imuSensor;
+    out.barometer = baro;
+    out.estimator = estimator;
+    out.lastEstimate = lastEstimate;
+}
+
+void simulation::restoreCheckpoint(const checkpoint& saved) {
+    stepCount = saved.step;
+    targetAltitude = saved.targetAltitude;
+    controllerEnabled = saved.controllerEnabled;
+    restoreBodyState(getDroneBody().bodyId, saved.drone);
+    restoreBodyState(getGround().bodyId, saved.ground);
+    restoreBodyState(getTargetLine().bodyId, saved.targetLine);
+    getDrone().setLastThrustValues(saved.thrust);
+    hover.setState(saved.controller);
+    setAltitudeGains(saved.gains.p, saved.gains.i, saved.gains.d);
+    cascade = saved.cascade;
+    config.controller = saved.activeController;
+    planner.setState(saved.planner);
+    imuSensor = saved.imu;
+    baro = saved.barometer;
+    estimator = saved.estimator;
+    lastEstimate = saved.lastEstimate;
+}
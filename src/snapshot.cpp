@@ -0,0 +1,52 @@
+#include <box2d/box2d.h>
+#include <cmath>
+#include "../include/snapshot.hpp"
+
+void captureDrone(drone& d, droneSnapshot& out) {
+    b2BodyId bodyId = d.getBodyId();
+    out.transform = b2Body_GetTransform(bodyId);
+    out.linearVelocity = b2Body_GetLinearVelocity(bodyId);
+    out.angularVelocity = b2Body_GetAngularVelocity(bodyId);
+    out.weight = d.gravitationalForce();
+    std::span<const b2Vec2> positions = d.getMotorPositions();
+    std::span<const b2Vec2> directions = d.getMotorDirections();
+    std::span<const float> thrust = d.getLastThrustValues();
+    out.motorPositions.assign(positions.begin(), positions.end());
+    out.motorDirections.assign(directions.begin(), directions.end());
+    out.thrust.assign(thrust.begin(), thrust.end());
+}
+
+void captureBodies(const entityRegistry& entities, const std::vector<entityHandle>& tracked, std::vector<b2Transform>& out) {
+    out.resize(tracked.size());
+    for (size_t i = 0; i < tracked.size(); ++i) {
+        const body* shape = entities.getBody(tracked[i]);
+        out[i] = shape ? b2Body_GetTransform(shape->bodyId) : b2Transform_identity;
+    }
+}
+
+// Linear position, normalized-linear rotation
+b2Transform interpolate(const b2Transform& a, const b2Transform& b, float alpha) {
+    b2Transform result;
+    result.p = { a.p.x + (b.p.x - a.p.x) * alpha, a.p.y + (b.p.y - a.p.y) * alpha };
+    float c = a.q.c + (b.q.c - a.q.c) * alpha;
+    float s = a.q.s + (b.q.s - a.q.s) * alpha;
+    float length = std::sqrt(c * c + s * s);
+    result.q = length > 0.0f ? b2Rot{ c / length, s / length } : b.q;
+    return result;
+}
+
+void interpolate(const worldSnapshot& a, const worldSnapshot& b, float alpha, worldSnapshot& out) {
+    out = b;
+    out.time = a.time + (b.time - a.time) * alpha;
+    if (a.bodyTransforms.size() == b.bodyTransforms.size()) {
+        for (size_t i = 0; i < b.bodyTransforms.size(); ++i) {
+            out.bodyTransforms[i] = interpolate(a.bodyTransforms[i], b.bodyTransforms[i], alpha);
+        }
+    }
+    out.droneState.transform = interpolate(a.droneState.transform, b.droneState.transform, alpha);
+    if (a.droneState.thrust.size() == b.droneState.thrust.size()) {
+        for (size_t i = 0; i < b.droneState.thrust.size(); ++i) {
+            out.droneState.thrust[i] = a.droneState.thrust[i] + (b.droneState.thrust[i] - a.droneState.thrust[i]) * alpha;
+        }
+    }
+}
@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include "../include/sprite_atlas.hpp"
+#include "../include/assets.hpp"
+
+size_t spriteAtlas::add(const std::string& name, const sf::Image& image) {
+    names.push_back(name);
+    images.push_back(image);
+    regions.push_back(sf::IntRect());
+    return regions.size() - 1;
+}
+
+// Copies the outermost pixels of a placed region outwards across its padding
+static void extrude(sf::Image& sheet, unsigned int x, unsigned int y, unsigned int width, unsigned int height, unsigned int padding) {
+    for (unsigned int row = y; row < y + height; ++row) {
+        sf::Color left = sheet.getPixel({ x, row });
+        sf::Color right = sheet.getPixel({ x + width - 1, row });
+        for (unsigned int k = 1; k <= padding; ++k) {
+            sheet.setPixel({ x - k, row }, left);
+            sheet.setPixel({ x + width - 1 + k, row }, right);
+        }
+    }
+    for (unsigned int column = x - padding; column < x + width + padding; ++column) {
+        sf::Color top = sheet.getPixel({ column, y });
+        sf::Color bottom = sheet.getPixel({ column, y + height - 1 });
+        for (unsigned int k = 1; k <= padding; ++k) {
+            sheet.setPixel({ column, y - k }, top);
+            sheet.setPixel({ column, y + height - 1 + k }, bottom);
+        }
+    }
+}
+
+bool spriteAtlas::build() {
+    if (images.empty()) {
+        std::cerr << "Sprite atlas has no images" << std::endl;
+        return false;
+    }
+    // Tallest first, so each shelf wastes little height
+    std::vector<size_t> order(images.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](size_t a, size_t b) { return images[a].getSize().y > images[b].getSize().y; });
+
+    unsigned int widest = 0;
+    double area = 0.0;
+    for (const sf::Image& image : images) {
+        widest = std::max(widest, image.getSize().x + 2 * padding);
+        area += static_cast<double>(image.getSize().x + 2 * padding) * (image.getSize().y + 2 * padding);
+    }
+    unsigned int width = 1;
+    while (width < std::max(widest, static_cast<unsigned int>(std::ceil(std::sqrt(area))))) {
+        width *= 2;
+    }
+
+    std::vector<sf::Vector2u> placement(images.size());
+    unsigned int x = 0;
+    unsigned int y = 0;
+    unsigned int shelfHeight = 0;
+    for (size_t i : order) {
+        sf::Vector2u size = images[i].getSize() + sf::Vector2u(2 * padding, 2 * padding);
+        if (x + size.x > width) {
+            y += shelfHeight;
+            x = 0;
+            shelfHeight = 0;
+        }
+        placement[i] = { x, y };
+        x += size.x;
+        shelfHeight = std::max(shelfHeight, size.y);
+    }
+    unsigned int height = y + shelfHeight;
+
+    sf::Image sheet({ width, height }, sf::Color::Transparent);
+    for (size_t i = 0; i < images.size(); ++i) {
+        sf::Vector2u size = images[i].getSize();
+        sf::Vector2u corner = placement[i] + sf::Vector2u(padding, padding);
+        if (size.x == 0 || size.y == 0 || !sheet.copy(images[i], corner)) {
+            std::cerr << "Failed to pack " << names[i] << " into the sprite atlas" << std::endl;
+            return false;
+        }
+        extrude(sheet, corner.x, corner.y, size.x, size.y, padding);
+        regions[i] = sf::IntRect(sf::Vector2i(corner), sf::Vector2i(size));
+    }
+
+    if (!texture.loadFromImage(sheet)) {
+        std::cerr << "Failed to create a " << width << "x" << height << " atlas texture" << std::endl;
+        return false;
+    }
+    texture.setSmooth(true);
+    if (!texture.generateMipmap()) {
+        std::cerr << "Atlas mipmaps unavailable; scaled-down sprites may shimmer" << std::endl;
+    }
+    images.clear();
+    return true;
+}
+
+size_t spriteAtlas::find(const std::string& name) const {
+    auto found = std::find(names.begin(), names.end(), name);
+    return found == names.end() ? SIZE_MAX : static_cast<size_t>(found - names.begin());
+}
+
+spriteBatch::spriteBatch(const spriteAtlas& atlas) {
+    this->atlas = &atlas;
+}
+
+void spriteBatch::add(size_t region, sf::Vector2f position, sf::Angle rotation, float scale, sf::Color tint) {
+    sf::IntRect rect = atlas->getRegion(region);
+    float halfWidth = rect.size.x * scale / 2.0f;
+    float halfHeight = rect.size.y * scale / 2.0f;
+    float c = std::cos(rotation.asRadians());
+    float s = std::sin(rotation.asRadians());
+    auto corner = [&](float x, float y) { return sf::Vector2f(position.x + x * c - y * s, position.y + x * s + y * c); };
+    sf::Vector2f topLeft = corner(-halfWidth, -halfHeight);
+    sf::Vector2f topRight = corner(halfWidth, -halfHeight);
+    sf::Vector2f bottomRight = corner(halfWidth, halfHeight);
+    sf::Vector2f bottomLeft = corner(-halfWidth, halfHeight);
+    float left = static_cast<float>(rect.position.x);
+    float top = static_cast<float>(rect.position.y);
+    float right = left + rect.size.x;
+    float bottom = top + rect.size.y;
+
+    vertices.push_back(sf::Vertex{ topLeft, tint, { left, top } });
+    vertices.push_back(sf::Vertex{ topRight, tint, { right, top } });
+    vertices.push_back(sf::Vertex{ bottomRight, tint, { right, bottom } });
+    vertices.push_back(sf::Vertex{ topLeft, tint, { left, top } });
+    vertices.push_back(sf::Vertex{ bottomRight, tint, { right, bottom } });
+    vertices.push_back(sf::Vertex{ bottomLeft, tint, { left, bottom } });
+}
+
+void spriteBatch::flush(sf::RenderTarget& target) {
+    if (vertices.empty()) {
+        return;
+    }
+    target.draw(vertices.data(), vertices.size(), sf::PrimitiveType::Triangles, sf::RenderStates(&atlas->getTexture()));
+    vertices.clear();
+}
+
+// Same artwork with the colour channels rotated, so the skins differ in hue but
+// keep the original's shading
+static sf::Image rotateChannels(const sf::Image& image, int shift) {
+    sf::Vector2u size = image.getSize();
+    const uint8_t* source = image.getPixelsPtr();
+    std::vector<uint8_t> pixels(static_cast<size_t>(size.x) * size.y * 4);
+    for (size_t p = 0; p < pixels.size(); p += 4) {
+        for (int channel = 0; channel < 3; ++channel) {
+            pixels[p + channel] = source[p + (channel + shift) % 3];
+        }
+        pixels[p + 3] = source[p + 3];
+    }
+    return sf::Image(size, pixels.data());
+}
+
+size_t addDroneSkins(spriteAtlas& atlas) {
+    const embeddedAsset* asset = findAsset("drone.png");
+    sf::Image base;
+    if (!asset || !base.loadFromMemory(asset->data, asset->size)) {
+        std::cerr << "Failed to load the embedded drone texture" << std::endl;
+        return 0;
+    }
+    atlas.add("drone", base);
+    atlas.add("drone/gbr", rotateChannels(base, 1));
+    atlas.add("drone/brg", rotateChannels(base, 2));
+    return 3;
+}
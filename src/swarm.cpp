@@ -0,0 +1,222 @@
+#include <box2d/box2d.h>
+#include <algorithm>
+#include "../include/swarm.hpp"
+
+void swarm::reserve(size_t drones, size_t motorsPerDrone) {
+    size_t motors = drones * motorsPerDrone;
+    for (auto* v : { &localCenterX, &localCenterY, &mass, &posX, &posY, &rotC, &rotS, &velX, &velY }) {
+        v->reserve(drones);
+    }
+    for (auto* v : { &motorPosX, &motorPosY, &motorDirX, &motorDirY, &maxThrust, &command, &lastThrust,
+                     &motorRotC, &motorRotS, &forceX, &forceY, &armX, &armY }) {
+        v->reserve(motors);
+    }
+    bodies.reserve(drones);
+    mixerIndex.reserve(drones);
+    motorBegin.reserve(drones);
+    motorEnd.reserve(drones);
+}
+
+size_t swarm::addDrone(b2BodyId bodyId, std::span<const b2Vec2> motorPositions, std::span<const b2Vec2> motorDirections, float maxThrustPerMotor) {
+    size_t index = bodies.size();
+    b2MassData massData = b2Body_GetMassData(bodyId);
+    b2Transform transform = b2Body_GetTransform(bodyId);
+    b2Vec2 velocity = b2Body_GetLinearVelocity(bodyId);
+
+    bodies.push_back(bodyId);
+    motorBegin.push_back(static_cast<uint32_t>(motorPosX.size()));
+    localCenterX.push_back(massData.center.x);
+    localCenterY.push_back(massData.center.y);
+    mass.push_back(massData.mass);
+    posX.push_back(transform.p.x);
+    posY.push_back(transform.p.y);
+    rotC.push_back(transform.q.c);
+    rotS.push_back(transform.q.s);
+    velX.push_back(velocity.x);
+    velY.push_back(velocity.y);
+
+    for (size_t i = 0; i < motorPositions.size() && i < motorDirections.size(); ++i) {
+        motorPosX.push_back(motorPositions[i].x);
+        motorPosY.push_back(motorPositions[i].y);
+        motorDirX.push_back(motorDirections[i].x);
+        motorDirY.push_back(motorDirections[i].y);
+        maxThrust.push_back(maxThrustPerMotor);
+        command.push_back(0.0f);
+        lastThrust.push_back(0.0f);
+        motorRotC.push_back(transform.q.c);
+        motorRotS.push_back(transform.q.s);
+        forceX.push_back(0.0f);
+        forceY.push_back(0.0f);
+        armX.push_back(0.0f);
+        armY.push_back(0.0f);
+    }
+    motorEnd.push_back(static_cast<uint32_t>(motorPosX.size()));
+
+    control::motorMixer mixer(motorPositions, motorDirections, maxThrustPerMotor);
+    auto existing = std::find(mixers.begin(), mixers.end(), mixer);
+    mixerIndex.push_back(static_cast<uint32_t>(existing - mixers.begin()));
+    if (existing == mixers.end()) {
+        mixers.push_back(mixer);
+    }
+    return index;
+}
+
+size_t swarm::addDrone(const drone& d) {
+    return addDrone(d.getBodyId(), d.getMotorPositions(), d.getMotorDirections(), d.getMaxThrustPerMotor());
+}
+
+float swarm::getMaxTotalThrust(size_t index) const {
+    float total = 0.0f;
+    for (uint32_t m = motorBegin[index]; m < motorEnd[index]; ++m) {
+        total += maxThrust[m];
+    }
+    return total;
+}
+
+void swarm::setThrust(size_t index, size_t motor, float thrust) {
+    command[motorBegin[index] + motor] = thrust;
+}
+
+void swarm::setThrustEvenly(size_t index, float thrust) {
+    uint32_t begin = motorBegin[index];
+    uint32_t end = motorEnd[index];
+    float perMotor = thrust / static_cast<float>(end - begin);
+    for (uint32_t m = begin; m < end; ++m) {
+        command[m] = perMotor;
+    }
+}
+
+void swarm::setWrench(size_t index, float collective, float torque) {
+    const control::motorMixer& mixer = mixers[mixerIndex[index]];
+    if (!mixer.isValid() || static_cast<uint32_t>(mixer.getMotorCount()) != motorEnd[index] - motorBegin[index]) {
+        setThrustEvenly(index, collective);
+        return;
+    }
+    mixer.mix(collective, torque, command.data() + motorBegin[index]);
+}
+
+void swarm::setWrenches(const float* collective, const float* torque) {
+    size_t n = bodies.size();
+    size_t runStart = 0;
+    while (runStart < n) {
+        size_t runEnd = runStart + 1;
+        while (runEnd < n && mixerIndex[runEnd] == mixerIndex[runStart]) {
+            ++runEnd;
+        }
+        const control::motorMixer& mixer = mixers[mixerIndex[runStart]];
+        if (mixer.isValid() && static_cast<uint32_t>(mixer.getMotorCount()) == motorEnd[runStart] - motorBegin[runStart]) {
+            mixer.mix(collective + runStart, torque + runStart, runEnd - runStart, command.data() + motorBegin[runStart]);
+        } else {
+            for (size_t i = runStart; i < runEnd; ++i) {
+                setThrustEvenly(i, collective[i]);
+            }
+        }
+        runStart = runEnd;
+    }
+}
+
+// One transform and velocity query per drone, broadcast to that drone's motors
+void swarm::syncState() {
+    size_t n = bodies.size();
+    for (size_t i = 0; i < n; ++i) {
+        b2Transform transform = b2Body_GetTransform(bodies[i]);
+        b2Vec2 velocity = b2Body_GetLinearVelocity(bodies[i]);
+        posX[i] = transform.p.x;
+        posY[i] = transform.p.y;
+        rotC[i] = transform.q.c;
+        rotS[i] = transform.q.s;
+        velX[i] = velocity.x;
+        velY[i] = velocity.y;
+        std::fill(motorRotC.begin() + motorBegin[i], motorRotC.begin() + motorEnd[i], transform.q.c);
+        std::fill(motorRotS.begin() + motorBegin[i], motorRotS.begin() + motorEnd[i], transform.q.s);
+    }
+}
+
+// Branch-free loop over flat arrays so the compiler can vectorize it
+void swarm::computeThrust() {
+    size_t n = motorPosX.size();
+    const float* __restrict px = motorPosX.data();
+    const float* __restrict py = motorPosY.data();
+    const float* __restrict dx = motorDirX.data();
+    const float* __restrict dy = motorDirY.data();
+    const float* __restrict c = motorRotC.data();
+    const float* __restrict s = motorRotS.data();
+    const float* __restrict cmd = command.data();
+    const float* __restrict limit = maxThrust.data();
+    float* __restrict thrust = lastThrust.data();
+    float* __restrict fx = forceX.data();
+    float* __restrict fy = forceY.data();
+    float* __restrict ax = armX.data();
+    float* __restrict ay = armY.data();
+
+    for (size_t m = 0; m < n; ++m) {
+        float t = std::min(std::max(cmd[m], 0.0f), limit[m]);
+        thrust[m] = t;
+        fx[m] = (c[m] * dx[m] - s[m] * dy[m]) * t;
+        fy[m] = (s[m] * dx[m] + c[m] * dy[m]) * t;
+        ax[m] = c[m] * px[m] - s[m] * py[m];
+        ay[m] = s[m] * px[m] + c[m] * py[m];
+    }
+}
+
+// Loads from the state cached by syncState() and this step's thrust
+void swarm::computeWind() {
+    size_t n = bodies.size();
+    bodyThrust.resize(n);
+    windForceX.resize(n);
+    windForceY.resize(n);
+    windTorque.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        float along = 0.0f;
+        for (uint32_t m = motorBegin[i]; m < motorEnd[i]; ++m) {
+            along += lastThrust[m] * motorDirY[m];
+        }
+        bodyThrust[i] = along;
+    }
+    windBodies state;
+    state.count = n;
+    state.posX = posX.data();
+    state.posY = posY.data();
+    state.rotC = rotC.data();
+    state.rotS = rotS.data();
+    state.velX = velX.data();
+    state.velY = velY.data();
+    state.thrust = bodyThrust.data();
+    computeWindLoads(*wind, windDrag, state, { windForceX.data(), windForceY.data(), windTorque.data() });
+}
+
+// Reduce motor forces to one force at the center of mass plus a torque per drone
+void swarm::applyForces() {
+    size_t n = bodies.size();
+    const bool windy = wind != nullptr;
+    for (size_t i = 0; i < n; ++i) {
+        float cx = rotC[i] * localCenterX[i] - rotS[i] * localCenterY[i];
+        float cy = rotS[i] * localCenterX[i] + rotC[i] * localCenterY[i];
+        float netX = 0.0f;
+        float netY = 0.0f;
+        float torque = 0.0f;
+        for (uint32_t m = motorBegin[i]; m < motorEnd[i]; ++m) {
+            netX += forceX[m];
+            netY += forceY[m];
+            torque += (armX[m] - cx) * forceY[m] - (armY[m] - cy) * forceX[m];
+        }
+        if (windy) {
+            netX += windForceX[i];
+            netY += windForceY[i];
+            torque += windTorque[i];
+        }
+        if (netX == 0.0f && netY == 0.0f && torque == 0.0f) {
+            continue;
+        }
+        b2Body_ApplyForceToCenter(bodies[i], { netX, netY }, true);
+        b2Body_ApplyTorque(bodies[i], torque, true);
+    }
+}
+
+void swarm::applyCommands() {
+    computeThrust();
+    if (wind) {
+        computeWind();
+    }
+    applyForces();
+}
@@ -0,0 +1,443 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include "../include/telemetry.hpp"
+#include "../include/profiler.hpp"
+
+// Bounds the work a command flood can add to one physics step
+static const int maxCommandDatagramsPerStep = 16;
+// Gaps older than this many entries are counted lost for good
+static const size_t maxTrackedGaps = 1024;
+
+namespace telemetry {
+
+uint64_t nowNanos() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static void put8(uint8_t*& p, uint8_t v) {
+    *p++ = v;
+}
+
+static void put16(uint8_t*& p, uint16_t v) {
+    put8(p, static_cast<uint8_t>(v));
+    put8(p, static_cast<uint8_t>(v >> 8));
+}
+
+static void put32(uint8_t*& p, uint32_t v) {
+    put16(p, static_cast<uint16_t>(v));
+    put16(p, static_cast<uint16_t>(v >> 16));
+}
+
+static void put64(uint8_t*& p, uint64_t v) {
+    put32(p, static_cast<uint32_t>(v));
+    put32(p, static_cast<uint32_t>(v >> 32));
+}
+
+static void putFloat(uint8_t*& p, float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    put32(p, bits);
+}
+
+static uint16_t get16(const uint8_t*& p) {
+    uint16_t v = static_cast<uint16_t>(p[0] | (p[1] << 8));
+    p += 2;
+    return v;
+}
+
+static uint32_t get32(const uint8_t*& p) {
+    uint32_t low = get16(p);
+    uint32_t high = get16(p);
+    return low | (high << 16);
+}
+
+static uint64_t get64(const uint8_t*& p) {
+    uint64_t low = get32(p);
+    uint64_t high = get32(p);
+    return low | (high << 32);
+}
+
+static float getFloat(const uint8_t*& p) {
+    uint32_t bits = get32(p);
+    float v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+void writeHeader(uint8_t* out, const header& h) {
+    put32(out, magic);
+    put8(out, version);
+    put8(out, h.type);
+    put16(out, h.count);
+    put32(out, h.sequence);
+    put64(out, h.sentNanos);
+    put32(out, h.ackSequence);
+    put64(out, h.ackNanos);
+}
+
+void writeState(std::vector<uint8_t>& out, const stateRecord& r) {
+    int motors = std::min<int>(r.motorCount, control::maxMixerMotors);
+    size_t offset = out.size();
+    out.resize(offset + stateRecordSize(motors));
+    uint8_t* p = out.data() + offset;
+    put32(p, r.step);
+    putFloat(p, r.time);
+    putFloat(p, r.x);
+    putFloat(p, r.y);
+    putFloat(p, r.angle);
+    putFloat(p, r.velX);
+    putFloat(p, r.velY);
+    putFloat(p, r.angularVelocity);
+    putFloat(p, r.targetAltitude);
+    putFloat(p, r.altitudeError);
+    put8(p, static_cast<uint8_t>(motors));
+    for (int m = 0; m < motors; ++m) {
+        putFloat(p, r.thrust[m]);
+    }
+}
+
+void writeCommand(std::vector<uint8_t>& out, const commandRecord& c) {
+    size_t offset = out.size();
+    out.resize(offset + commandRecordSize);
+    uint8_t* p = out.data() + offset;
+    put8(p, static_cast<uint8_t>(c.type));
+    putFloat(p, c.a);
+    putFloat(p, c.b);
+    putFloat(p, c.c);
+}
+
+bool readHeader(const uint8_t* data, size_t size, header& h) {
+    if (size < headerSize) {
+        return false;
+    }
+    const uint8_t* p = data;
+    if (get32(p) != magic || *p++ != version) {
+        return false;
+    }
+    h.type = *p++;
+    h.count = get16(p);
+    h.sequence = get32(p);
+    h.sentNanos = get64(p);
+    h.ackSequence = get32(p);
+    h.ackNanos = get64(p);
+    return true;
+}
+
+bool readState(const uint8_t* data, size_t size, size_t& offset, stateRecord& r) {
+    if (offset + stateRecordSize(0) > size) {
+        return false;
+    }
+    const uint8_t* p = data + offset;
+    r.step = get32(p);
+    r.time = getFloat(p);
+    r.x = getFloat(p);
+    r.y = getFloat(p);
+    r.angle = getFloat(p);
+    r.velX = getFloat(p);
+    r.velY = getFloat(p);
+    r.angularVelocity = getFloat(p);
+    r.targetAltitude = getFloat(p);
+    r.altitudeError = getFloat(p);
+    r.motorCount = *p++;
+    if (r.motorCount > control::maxMixerMotors || offset + stateRecordSize(r.motorCount) > size) {
+        return false;
+    }
+    for (int m = 0; m < control::maxMixerMotors; ++m) {
+        r.thrust[m] = m < r.motorCount ? getFloat(p) : 0.0f;
+    }
+    offset += stateRecordSize(r.motorCount);
+    return true;
+}
+
+bool readCommand(const uint8_t* data, size_t size, size_t& offset, commandRecord& c) {
+    if (offset + commandRecordSize > size) {
+        return false;
+    }
+    const uint8_t* p = data + offset;
+    c.type = static_cast<commandType>(*p++);
+    c.a = getFloat(p);
+    c.b = getFloat(p);
+    c.c = getFloat(p);
+    offset += commandRecordSize;
+    return true;
+}
+
+stateRecord captureState(uint64_t step, simulation& sim) {
+    stateRecord r;
+    b2BodyId bodyId = sim.getDroneBody().bodyId;
+    b2Transform transform = b2Body_GetTransform(bodyId);
+    b2Vec2 velocity = b2Body_GetLinearVelocity(bodyId);
+    std::span<const float> thrust = sim.getDrone().getLastThrustValues();
+
+    r.step = static_cast<uint32_t>(step);
+    r.time = static_cast<float>(step * static_cast<double>(sim.getConfig().timeStep));
+    r.x = transform.p.x;
+    r.y = transform.p.y;
+    r.angle = b2Rot_GetAngle(transform.q);
+    r.velX = velocity.x;
+    r.velY = velocity.y;
+    r.angularVelocity = b2Body_GetAngularVelocity(bodyId);
+    r.targetAltitude = sim.getTargetAltitude();
+    r.altitudeError = r.targetAltitude - r.y;
+    r.motorCount = static_cast<uint8_t>(std::min<size_t>(thrust.size(), control::maxMixerMotors));
+    for (int m = 0; m < control::maxMixerMotors; ++m) {
+        r.thrust[m] = m < r.motorCount ? thrust[m] : 0.0f;
+    }
+    return r;
+}
+
+}
+
+using namespace telemetry;
+
+telemetryServer::telemetryServer() {
+    this->loop = nullptr;
+    this->peerPort = 0;
+    this->commandPort = 0;
+    this->pending = 0;
+    this->sequence = 0;
+    this->ackSequence = 0;
+    this->ackNanos = 0;
+}
+
+bool telemetryServer::open(const telemetryConfig& config, physicsLoop* loop) {
+    this->config = config;
+    this->config.batch = std::max(1, config.batch);
+    this->config.decimation = std::max(1, config.decimation);
+    this->loop = loop;
+    socket.setBlocking(false);
+    if (socket.bind(config.port) != sf::Socket::Status::Done) {
+        std::cerr << "Failed to bind telemetry socket to port " << config.port << std::endl;
+        return false;
+    }
+    peer = config.peer;
+    peerPort = config.peerPort;
+    datagram.reserve(maxDatagramSize);
+    beginDatagram();
+    return true;
+}
+
+void telemetryServer::beginDatagram() {
+    datagram.assign(headerSize, 0);
+    pending = 0;
+}
+
+void telemetryServer::afterStep(uint64_t step, simulation& sim) {
+    PROFILE_ZONE("telemetry");
+    pollCommands(sim);
+    if (!peer || step % config.decimation != 0) {
+        return;
+    }
+    stateRecord r = captureState(step, sim);
+    if (datagram.size() + stateRecordSize(r.motorCount) > maxDatagramSize) {
+        flush();
+    }
+    writeState(datagram, r);
+    ++pending;
+    ++stats.records;
+    if (pending >= config.batch) {
+        flush();
+    }
+}
+
+void telemetryServer::flush() {
+    if (pending == 0 || !peer) {
+        return;
+    }
+    header h = { static_cast<uint8_t>(packetType::state), static_cast<uint16_t>(pending), ++sequence, nowNanos(), ackSequence, ackNanos };
+    writeHeader(datagram.data(), h);
+    // A full send buffer drops this batch; the gap in the sequence tells the receiver
+    if (socket.send(datagram.data(), datagram.size(), *peer, peerPort) == sf::Socket::Status::Done) {
+        ++stats.datagrams;
+    } else {
+        ++stats.sendFailures;
+    }
+    beginDatagram();
+}
+
+void telemetryServer::pollCommands(simulation& sim) {
+    for (int i = 0; i < maxCommandDatagramsPerStep; ++i) {
+        size_t received = 0;
+        std::optional<sf::IpAddress> sender;
+        unsigned short senderPort = 0;
+        if (socket.receive(receiveBuffer, sizeof(receiveBuffer), received, sender, senderPort) != sf::Socket::Status::Done) {
+            return;
+        }
+        header h;
+        if (!readHeader(receiveBuffer, received, h) || h.type != static_cast<uint8_t>(packetType::command) ||
+            headerSize + h.count * commandRecordSize > received) {
+            ++stats.rejected;
+            continue;
+        }
+        // Only the peer may command: the configured host, or else the first client
+        // to send a valid command, which then keeps the stream. Anyone else can
+        // neither steer the drone nor redirect the stream.
+        if (!sender || (config.peer && *sender != *config.peer) ||
+            (!config.peer && peer && (sender != peer || senderPort != peerPort))) {
+            ++stats.rejected;
+            continue;
+        }
+        if (!peer) {
+            peer = sender;
+            peerPort = senderPort;
+        }
+        // A restarted client numbers its commands from scratch
+        if (sender != commandSender || senderPort != commandPort) {
+            commandSender = sender;
+            commandPort = senderPort;
+            ackSequence = 0;
+        }
+        // Datagrams can arrive out of order; an older command must not undo a newer one
+        if (h.sequence <= ackSequence) {
+            continue;
+        }
+        ackSequence = h.sequence;
+        ackNanos = h.sentNanos;
+        size_t offset = headerSize;
+        commandRecord command;
+        for (int c = 0; c < h.count && readCommand(receiveBuffer, received, offset, command); ++c) {
+            apply(command, sim);
+            ++stats.commands;
+        }
+    }
+}
+
+void telemetryServer::apply(const commandRecord& command, simulation& sim) {
+    switch (command.type) {
+    case commandType::hello:
+        break;
+    case commandType::setpoint:
+        if (!std::isfinite(command.a)) {
+            ++stats.rejected;
+        } else if (loop) {
+            loop->setTargetAltitude(command.a);
+        } else {
+            sim.setTargetAltitude(command.a);
+        }
+        break;
+    case commandType::gains:
+        if (!std::isfinite(command.a) || !std::isfinite(command.b) || !std::isfinite(command.c)) {
+            ++stats.rejected;
+        } else {
+            sim.setAltitudeGains(command.a, command.b, command.c);
+        }
+        break;
+    case commandType::enable:
+        if (loop) {
+            loop->setControllerEnabled(command.a != 0.0f);
+        } else {
+            sim.setControllerEnabled(command.a != 0.0f);
+        }
+        break;
+    case commandType::controller: {
+        int kind = static_cast<int>(command.a);
+        if (kind < 0 || kind > static_cast<int>(controllerKind::mppi)) {
+            ++stats.rejected;
+        } else if (loop) {
+            loop->setControllerKind(static_cast<controllerKind>(kind));
+        } else {
+            sim.setControllerKind(static_cast<controllerKind>(kind));
+        }
+        break;
+    }
+    default:
+        ++stats.rejected;
+        break;
+    }
+}
+
+telemetryClient::telemetryClient()
+    : server(sf::IpAddress::LocalHost) {
+    this->serverPort = 0;
+    this->sequence = 0;
+    this->highestSequence = 0;
+    this->received = false;
+    this->lastAck = 0;
+}
+
+bool telemetryClient::open(sf::IpAddress server, unsigned short serverPort) {
+    this->server = server;
+    this->serverPort = serverPort;
+    socket.setBlocking(false);
+    if (socket.bind(sf::Socket::AnyPort) != sf::Socket::Status::Done) {
+        std::cerr << "Failed to bind telemetry client socket" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool telemetryClient::send(const std::vector<commandRecord>& commands) {
+    if (headerSize + commands.size() * commandRecordSize > maxDatagramSize) {
+        return false;
+    }
+    datagram.assign(headerSize, 0);
+    for (const commandRecord& command : commands) {
+        writeCommand(datagram, command);
+    }
+    header h = { static_cast<uint8_t>(packetType::command), static_cast<uint16_t>(commands.size()), ++sequence, nowNanos(), 0, 0 };
+    writeHeader(datagram.data(), h);
+    return socket.send(datagram.data(), datagram.size(), server, serverPort) == sf::Socket::Status::Done;
+}
+
+void telemetryClient::track(uint32_t sequence) {
+    if (!received || sequence > highestSequence) {
+        if (received) {
+            for (uint32_t gap = highestSequence + 1; gap < sequence; ++gap) {
+                missing.push_back(gap);
+                ++stats.lost;
+            }
+            if (missing.size() > maxTrackedGaps) {
+                missing.erase(missing.begin(), missing.end() - maxTrackedGaps);
+            }
+        }
+        highestSequence = sequence;
+        received = true;
+        return;
+    }
+    auto late = std::find(missing.begin(), missing.end(), sequence);
+    if (late != missing.end()) {
+        missing.erase(late);
+        --stats.lost;
+        ++stats.reordered;
+    } else {
+        ++stats.duplicates;
+    }
+}
+
+size_t telemetryClient::poll(std::vector<stateRecord>* out) {
+    size_t records = 0;
+    while (true) {
+        size_t size = 0;
+        std::optional<sf::IpAddress> sender;
+        unsigned short senderPort = 0;
+        if (socket.receive(receiveBuffer, sizeof(receiveBuffer), size, sender, senderPort) != sf::Socket::Status::Done) {
+            return records;
+        }
+        uint64_t arrival = nowNanos();
+        header h;
+        if (!readHeader(receiveBuffer, size, h) || h.type != static_cast<uint8_t>(packetType::state)) {
+            ++stats.rejected;
+            continue;
+        }
+        ++stats.datagrams;
+        track(h.sequence);
+        stats.latencySeconds.push_back(static_cast<int64_t>(arrival - h.sentNanos) * 1e-9);
+        if (h.ackSequence > lastAck && h.ackSequence <= sequence) {
+            lastAck = h.ackSequence;
+            stats.roundTripSeconds.push_back(static_cast<int64_t>(arrival - h.ackNanos) * 1e-9);
+        }
+        size_t offset = headerSize;
+        stateRecord r;
+        for (int i = 0; i < h.count && readState(receiveBuffer, size, offset, r); ++i) {
+            ++records;
+            ++stats.records;
+            if (out) {
+                out->push_back(r);
+            }
+        }
+    }
+}
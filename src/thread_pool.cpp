@@ -0,0 +1,197 @@
+#include "../include/thread_pool.hpp"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Box2D's per-worker contexts are sized by this
+static constexpr unsigned int maxBox2dWorkers = 64;
+
+// Which pool, if any, the current thread is a worker of
+static thread_local const threadPool* currentPool = nullptr;
+static thread_local uint32_t currentIndex = 0;
+
+static bool pinToCore(std::thread& thread, unsigned int core) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+    (void)thread;
+    (void)core;
+    return false;
+#endif
+}
+
+threadPool::threadPool(const threadPoolConfig& config) {
+    this->config = config;
+    unsigned int cores = std::max(std::thread::hardware_concurrency(), 1u);
+    unsigned int threads = config.threads ? config.threads : cores;
+    threads = std::clamp(threads, 1u, maxBox2dWorkers);
+    for (unsigned int i = 0; i < threads; ++i) {
+        queues.push_back(std::make_unique<taskQueue>());
+    }
+    this->pinned = config.pinThreads;
+    for (unsigned int i = 0; i + 1 < threads; ++i) {
+        workers.emplace_back(&threadPool::workerMain, this, i);
+        if (config.pinThreads) {
+            pinned = pinToCore(workers.back(), (config.firstCore + i) % cores) && pinned;
+        }
+    }
+}
+
+threadPool::~threadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true);
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+uint32_t threadPool::currentWorker() const {
+    return currentPool == this ? currentIndex : workerCount();
+}
+
+void threadPool::submit(taskGroup& group, taskFn fn, void* context, size_t begin, size_t end) {
+    group.pending.fetch_add(1, std::memory_order_relaxed);
+    taskQueue& queue = *queues[currentWorker()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back({ fn, context, begin, end, &group });
+    }
+    queued.fetch_add(1);
+    if (sleepers.load() > 0) {
+        { std::lock_guard<std::mutex> lock(sleepMutex); }
+        wake.notify_one();
+    }
+}
+
+// Own queue first, then steal, oldest task first. With onlyGroup set, the
+// oldest task of that group, wherever it sits in the queue.
+bool threadPool::tryRunOne(uint32_t self, const taskGroup* onlyGroup) {
+    if (queued.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    size_t count = queues.size();
+    for (size_t i = 0; i < count; ++i) {
+        taskQueue& queue = *queues[(self + i) % count];
+        task next;
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            auto found = queue.tasks.begin();
+            if (onlyGroup) {
+                found = std::find_if(queue.tasks.begin(), queue.tasks.end(), [onlyGroup](const task& t) { return t.group == onlyGroup; });
+            }
+            if (found == queue.tasks.end()) {
+                continue;
+            }
+            next = *found;
+            queue.tasks.erase(found);
+        }
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        next.fn(next.context, next.begin, next.end, self);
+        next.group->pending.fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+    return false;
+}
+
+void threadPool::wait(taskGroup& group) {
+    uint32_t self = currentWorker();
+    while (group.pending.load(std::memory_order_acquire) > 0) {
+        if (!tryRunOne(self, &group)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void threadPool::workerMain(uint32_t index) {
+    currentPool = this;
+    currentIndex = index;
+    while (!stopping.load(std::memory_order_relaxed)) {
+        if (tryRunOne(index, nullptr)) {
+            continue;
+        }
+        // Brief spin before sleeping keeps latency low between back-to-back sections
+        bool found = false;
+        for (int spin = 0; spin < 64 && !found; ++spin) {
+            std::this_thread::yield();
+            found = queued.load(std::memory_order_relaxed) > 0;
+        }
+        if (found) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepers.fetch_add(1);
+        wake.wait(lock, [this] { return stopping.load() || queued.load() > 0; });
+        sleepers.fetch_sub(1);
+    }
+}
+
+void threadPool::runBox2dChunk(void* context, size_t begin, size_t end, uint32_t workerIndex) {
+    box2dTask* t = static_cast<box2dTask*>(context);
+    t->callback(static_cast<int>(begin), static_cast<int>(end), workerIndex, t->context);
+}
+
+void* threadPool::enqueueBox2dTask(b2TaskCallback* callback, int itemCount, int minRange, void* taskContext, void* userContext) {
+    threadPool* pool = static_cast<threadPool*>(userContext);
+    std::unique_ptr<box2dTask> t;
+    {
+        std::lock_guard<std::mutex> lock(pool->box2dMutex);
+        if (!pool->box2dFree.empty()) {
+            t = std::move(pool->box2dFree.back());
+            pool->box2dFree.pop_back();
+        }
+    }
+    if (!t) {
+        t = std::make_unique<box2dTask>();
+    }
+    t->callback = callback;
+    t->context = taskContext;
+
+    // Always enqueue, even a single item: the solver's tasks must be able to run concurrently
+    size_t items = static_cast<size_t>(itemCount);
+    size_t range = static_cast<size_t>(std::max(minRange, 1));
+    size_t chunks = std::clamp<size_t>(items / range, 1, pool->concurrency());
+    size_t chunkSize = (items + chunks - 1) / chunks;
+    for (size_t begin = 0; begin < items; begin += chunkSize) {
+        pool->submit(t->group, &threadPool::runBox2dChunk, t.get(), begin, std::min(begin + chunkSize, items));
+    }
+    return t.release();
+}
+
+void threadPool::finishBox2dTask(void* userTask, void* userContext) {
+    threadPool* pool = static_cast<threadPool*>(userContext);
+    std::unique_ptr<box2dTask> t(static_cast<box2dTask*>(userTask));
+    pool->wait(t->group);
+    std::lock_guard<std::mutex> lock(pool->box2dMutex);
+    pool->box2dFree.push_back(std::move(t));
+}
+
+void threadPool::attach(b2WorldDef& worldDef) {
+    worldDef.workerCount = static_cast<int>(concurrency());
+    worldDef.enqueueTask = &threadPool::enqueueBox2dTask;
+    worldDef.finishTask = &threadPool::finishBox2dTask;
+    worldDef.userTaskContext = this;
+}
+
+static threadPoolConfig sharedConfig;
+static std::atomic<bool> sharedCreated{false};
+
+bool configureSharedThreadPool(const threadPoolConfig& config) {
+    if (sharedCreated.load()) {
+        return false;
+    }
+    sharedConfig = config;
+    return true;
+}
+
+threadPool& sharedThreadPool() {
+    static threadPool pool((sharedCreated.store(true), sharedConfig));
+    return pool;
+}
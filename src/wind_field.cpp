@@ -0,0 +1,282 @@
+#include <algorithm>
+#include <cmath>
+#include "../include/wind_field.hpp"
+#include "../include/estimation/sensors.hpp"
+
+static const float pi = 3.14159265f;
+// Temporal harmonics of the turbulence loop, amplitude falling off as 1/n
+static const int turbulenceHarmonics = 3;
+// Drones per pass of computeWindLoads; both span ends' sample points fit on the stack
+static const size_t windChunk = 128;
+
+// 3x3 box blur with clamped borders
+static void smooth(std::vector<float>& field, std::vector<float>& scratch, int columns, int rows) {
+    scratch.resize(field.size());
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < columns; ++x) {
+            float sum = 0.0f;
+            for (int dy = -1; dy <= 1; ++dy) {
+                int row = std::clamp(y + dy, 0, rows - 1);
+                for (int dx = -1; dx <= 1; ++dx) {
+                    sum += field[row * columns + std::clamp(x + dx, 0, columns - 1)];
+                }
+            }
+            scratch[y * columns + x] = sum / 9.0f;
+        }
+    }
+    field.swap(scratch);
+}
+
+// Smoothed white noise rescaled to zero mean and unit variance
+static std::vector<float> correlatedNoise(estimation::noiseSource& rng, int columns, int rows, int passes) {
+    std::vector<float> field(static_cast<size_t>(columns) * rows);
+    std::vector<float> scratch;
+    for (float& value : field) {
+        value = rng.gaussian();
+    }
+    for (int pass = 0; pass < passes; ++pass) {
+        smooth(field, scratch, columns, rows);
+    }
+    double mean = 0.0;
+    for (float value : field) {
+        mean += value;
+    }
+    mean /= field.size();
+    double variance = 0.0;
+    for (float value : field) {
+        variance += (value - mean) * (value - mean);
+    }
+    float scale = variance > 0.0 ? static_cast<float>(1.0 / std::sqrt(variance / field.size())) : 0.0f;
+    for (float& value : field) {
+        value = static_cast<float>(value - mean) * scale;
+    }
+    return field;
+}
+
+windField::windField(const windConfig& config) {
+    this->config = config;
+    this->config.columns = std::max(config.columns, 2);
+    this->config.rows = std::max(config.rows, 2);
+    this->config.frames = std::max(config.frames, 1);
+    this->config.cellSize = std::max(config.cellSize, 1.0e-3f);
+    this->config.frameInterval = std::max(config.frameInterval, 1.0e-3f);
+    this->cellCount = static_cast<size_t>(this->config.columns) * this->config.rows;
+    this->period = this->config.frames * this->config.frameInterval;
+    this->time = 0.0f;
+    float meanSpeed = std::sqrt(config.mean.x * config.mean.x + config.mean.y * config.mean.y);
+    this->gustDirection = meanSpeed > 0.0f ? b2Vec2{ config.mean.x / meanSpeed, config.mean.y / meanSpeed } : b2Vec2{ 1.0f, 0.0f };
+    buildTurbulence();
+
+    estimation::noiseSource rng(this->config.seed * 0x9E3779B97F4A7C15ull + 1);
+    if (this->config.gustSpeed > 0.0f && this->config.gustInterval > 0.0f) {
+        // Poisson onsets over one loop of the field
+        for (float onset = -this->config.gustInterval * std::log(rng.uniform()); onset < period;
+             onset -= this->config.gustInterval * std::log(rng.uniform())) {
+            gustOnsets.push_back(onset);
+        }
+    }
+    currentU.resize(cellCount);
+    currentV.resize(cellCount);
+    advance(0.0f);
+}
+
+// Each cell's component is a sum of a few harmonics of the loop period with
+// random, spatially correlated coefficients, so frames vary smoothly in time and
+// the last frame leads back into the first
+void windField::buildTurbulence() {
+    frameU.assign(config.frames * cellCount, 0.0f);
+    frameV.assign(config.frames * cellCount, 0.0f);
+    if (config.turbulence <= 0.0f) {
+        return;
+    }
+    estimation::noiseSource rng(config.seed);
+    float power = 0.0f;
+    for (int n = 1; n <= turbulenceHarmonics; ++n) {
+        power += 1.0f / (n * n);
+    }
+    const float scale = config.turbulence / std::sqrt(power);
+    for (std::vector<float>* frames : { &frameU, &frameV }) {
+        for (int n = 1; n <= turbulenceHarmonics; ++n) {
+            std::vector<float> cosine = correlatedNoise(rng, config.columns, config.rows, config.smoothing);
+            std::vector<float> sine = correlatedNoise(rng, config.columns, config.rows, config.smoothing);
+            for (int k = 0; k < config.frames; ++k) {
+                float phase = 2.0f * pi * n * k / config.frames;
+                float a = scale / n * std::cos(phase);
+                float b = scale / n * std::sin(phase);
+                float* frame = frames->data() + k * cellCount;
+                for (size_t cell = 0; cell < cellCount; ++cell) {
+                    frame[cell] += a * cosine[cell] + b * sine[cell];
+                }
+            }
+        }
+    }
+}
+
+// Sum of the 1-cosine gusts active at `time`, including one that started before the loop wrapped
+b2Vec2 windField::gustAt(float time) const {
+    if (gustOnsets.empty()) {
+        return { 0.0f, 0.0f };
+    }
+    float local = std::fmod(time, period);
+    local = local < 0.0f ? local + period : local;
+    float speed = 0.0f;
+    for (float onset : gustOnsets) {
+        for (float since : { local - onset, local - onset + period }) {
+            if (since >= 0.0f && since < config.gustDuration) {
+                speed += 0.5f * config.gustSpeed * (1.0f - std::cos(2.0f * pi * since / config.gustDuration));
+            }
+        }
+    }
+    return { gustDirection.x * speed, gustDirection.y * speed };
+}
+
+void windField::advance(float time) {
+    this->time = time;
+    float position = time / config.frameInterval;
+    float whole = std::floor(position);
+    float blend = position - whole;
+    int first = static_cast<int>(std::fmod(whole, static_cast<float>(config.frames)));
+    first = first < 0 ? first + config.frames : first;
+    int second = (first + 1) % config.frames;
+    b2Vec2 gust = gustAt(time);
+    const float baseU = config.mean.x + gust.x;
+    const float baseV = config.mean.y + gust.y;
+
+    const float* u0 = frameU.data() + first * cellCount;
+    const float* u1 = frameU.data() + second * cellCount;
+    const float* v0 = frameV.data() + first * cellCount;
+    const float* v1 = frameV.data() + second * cellCount;
+    float* u = currentU.data();
+    float* v = currentV.data();
+    for (size_t cell = 0; cell < cellCount; ++cell) {
+        u[cell] = baseU + u0[cell] + blend * (u1[cell] - u0[cell]);
+        v[cell] = baseV + v0[cell] + blend * (v1[cell] - v0[cell]);
+    }
+}
+
+b2Vec2 windField::sample(float x, float y) const {
+    b2Vec2 wind;
+    sample(&x, &y, 1, &wind.x, &wind.y);
+    return wind;
+}
+
+// Clamped bilinear lookup written without branches so the loop vectorizes
+void windField::sample(const float* x, const float* y, size_t count, float* u, float* v) const {
+    const float inverseCell = 1.0f / config.cellSize;
+    const float maxX = static_cast<float>(config.columns - 1);
+    const float maxY = static_cast<float>(config.rows - 1);
+    const int lastColumn = config.columns - 2;
+    const int lastRow = config.rows - 2;
+    const int stride = config.columns;
+    const float* gridU = currentU.data();
+    const float* gridV = currentV.data();
+    for (size_t i = 0; i < count; ++i) {
+        float gx = std::min(std::max((x[i] - config.origin.x) * inverseCell, 0.0f), maxX);
+        float gy = std::min(std::max((y[i] - config.origin.y) * inverseCell, 0.0f), maxY);
+        int column = std::min(static_cast<int>(gx), lastColumn);
+        int row = std::min(static_cast<int>(gy), lastRow);
+        float tx = gx - column;
+        float ty = gy - row;
+        int cell = row * stride + column;
+        float bottomU = gridU[cell] + tx * (gridU[cell + 1] - gridU[cell]);
+        float topU = gridU[cell + stride] + tx * (gridU[cell + stride + 1] - gridU[cell + stride]);
+        float bottomV = gridV[cell] + tx * (gridV[cell + 1] - gridV[cell]);
+        float topV = gridV[cell + stride] + tx * (gridV[cell + stride + 1] - gridV[cell + stride]);
+        u[i] = bottomU + ty * (topU - bottomU);
+        v[i] = bottomV + ty * (topV - bottomV);
+    }
+}
+
+float groundEffectGain(float radius, float height) {
+    if (radius <= 0.0f) {
+        return 1.0f;
+    }
+    // The model diverges at the ground; hold it at half a radius, a 4/3 gain
+    float ratio = radius / (4.0f * std::max(height, 0.5f * radius));
+    return 1.0f / (1.0f - ratio * ratio);
+}
+
+float windField::groundEffect(float height) const {
+    return groundEffectGain(config.rotorRadius, height);
+}
+
+void computeWindLoads(const windField& field, const airframeDrag& airframe, const windBodies& bodies, const windLoads& out) {
+    // Each span end carries half the airframe's area
+    const float frontal = 0.25f * airframe.airDensity * airframe.dragCoefficient * airframe.frontalArea;
+    const float planform = 0.25f * airframe.airDensity * airframe.dragCoefficient * airframe.planformArea;
+    const windConfig& config = field.getConfig();
+    const bool groundEffect = bodies.thrust && config.rotorRadius > 0.0f;
+
+    float sampleX[2 * windChunk];
+    float sampleY[2 * windChunk];
+    float windU[2 * windChunk];
+    float windV[2 * windChunk];
+    for (size_t begin = 0; begin < bodies.count; begin += windChunk) {
+        size_t count = std::min(windChunk, bodies.count - begin);
+        const float* px = bodies.posX + begin;
+        const float* py = bodies.posY + begin;
+        const float* c = bodies.rotC + begin;
+        const float* s = bodies.rotS + begin;
+        const float* vx = bodies.velX + begin;
+        const float* vy = bodies.velY + begin;
+
+        // Right ends first, then left ends
+        for (size_t i = 0; i < count; ++i) {
+            float armX = airframe.halfSpan * c[i];
+            float armY = airframe.halfSpan * s[i];
+            sampleX[i] = px[i] + armX;
+            sampleY[i] = py[i] + armY;
+            sampleX[count + i] = px[i] - armX;
+            sampleY[count + i] = py[i] - armY;
+        }
+        field.sample(sampleX, sampleY, 2 * count, windU, windV);
+
+        float* fx = out.forceX + begin;
+        float* fy = out.forceY + begin;
+        float* torque = out.torque + begin;
+        for (size_t i = 0; i < count; ++i) {
+            float armX = airframe.halfSpan * c[i];
+            float armY = airframe.halfSpan * s[i];
+            float forceX = 0.0f;
+            float forceY = 0.0f;
+            float moment = 0.0f;
+            for (int end = 0; end < 2; ++end) {
+                size_t k = end * count + i;
+                float sign = end == 0 ? 1.0f : -1.0f;
+                // Relative air velocity in the body frame, where the areas are defined
+                float airX = windU[k] - vx[i];
+                float airY = windV[k] - vy[i];
+                float bodyX = c[i] * airX + s[i] * airY;
+                float bodyY = c[i] * airY - s[i] * airX;
+                float dragX = frontal * bodyX * std::abs(bodyX);
+                float dragY = planform * bodyY * std::abs(bodyY);
+                float worldX = c[i] * dragX - s[i] * dragY;
+                float worldY = s[i] * dragX + c[i] * dragY;
+                forceX += worldX;
+                forceY += worldY;
+                moment += sign * (armX * worldY - armY * worldX);
+            }
+            fx[i] = forceX;
+            fy[i] = forceY;
+            torque[i] = moment;
+        }
+
+        if (groundEffect) {
+            const float* thrust = bodies.thrust + begin;
+            for (size_t i = 0; i < count; ++i) {
+                float extra = (field.groundEffect(py[i] - config.groundLevel) - 1.0f) * thrust[i];
+                fx[i] -= s[i] * extra;
+                fy[i] += c[i] * extra;
+            }
+        }
+    }
+}
+
+windConfig windConfigOver(const windConfig& base, b2Vec2 lower, b2Vec2 upper, float cellSize) {
+    windConfig config = base;
+    config.origin = lower;
+    config.cellSize = cellSize;
+    config.columns = std::max(2, static_cast<int>(std::ceil((upper.x - lower.x) / cellSize)) + 1);
+    config.rows = std::max(2, static_cast<int>(std::ceil((upper.y - lower.y) / cellSize)) + 1);
+    return config;
+}